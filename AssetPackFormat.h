@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// File: AssetPackFormat.h
+//
+// Desc: On disk layout of the single file asset pack, shared by the offline
+//	   packer (tools/AssetPacker) and the runtime reader (CAssetPack).
+//
+//	   [PackHeader][entry data, each ALIGNMENT aligned ...][PackEntry * nBuckets]
+//
+//	   The index is an open addressing hash table keyed by the FNV-1a hash of
+//	   the normalised asset path, probed linearly. Hash 0 marks a free bucket.
+//-----------------------------------------------------------------------------
+
+#ifndef _ASSETPACKFORMAT_H_
+#define _ASSETPACKFORMAT_H_
+
+//-----------------------------------------------------------------------------
+// AssetPackFormat Specific Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+
+//-----------------------------------------------------------------------------
+// Constants
+//-----------------------------------------------------------------------------
+const char				PACK_MAGIC[4]		= { 'C', 'G', 'P', 'K' };
+const uint32_t			PACK_VERSION		= 1;
+const uint32_t			PACK_ALIGNMENT		= 16;
+const uint32_t			PACK_FLAG_LZ4		= 0x1;		// Entry is an LZ4 block
+
+//-----------------------------------------------------------------------------
+// Structures
+//-----------------------------------------------------------------------------
+#pragma pack(push, 1)
+struct PackHeader
+{
+	char		Magic[4];
+	uint32_t	Version;
+	uint32_t	nEntries;
+	uint32_t	nBuckets;		// Power of two
+	uint64_t	IndexOffset;
+};
+
+struct PackEntry
+{
+	uint64_t	Hash;			// 0 for an empty bucket
+	uint64_t	Offset;			// From the start of the file
+	uint32_t	PackedSize;		// Bytes stored
+	uint32_t	Size;			// Bytes after decoding
+	uint32_t	Flags;
+	uint32_t	Reserved;
+};
+#pragma pack(pop)
+
+//-----------------------------------------------------------------------------
+// Name : HashAssetPath ()
+// Desc : FNV-1a 64 of the path, case insensitive and with '\' read as '/'.
+//-----------------------------------------------------------------------------
+inline uint64_t HashAssetPath( const char* szPath )
+{
+	uint64_t h = 14695981039346656037ull;
+	for ( ; *szPath; ++szPath )
+	{
+		char c = *szPath;
+		if ( c == '\\' ) c = '/';
+		if ( c >= 'A' && c <= 'Z' ) c = (char)( c - 'A' + 'a' );
+		h = ( h ^ (unsigned char)c ) * 1099511628211ull;
+	}
+	return h ? h : 1;
+}
+
+#endif // _ASSETPACKFORMAT_H_
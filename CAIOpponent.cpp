@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------------------
+// File: CAIOpponent.cpp
+//
+// Desc: CPU controlled player. Runs a bounded beam search over CSimState
+//	   rollouts, expanding each search depth in parallel on the thread pool
+//	   and stopping when the per tick time budget runs out.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAIOpponent Specific Includes
+//-----------------------------------------------------------------------------
+#include "CAIOpponent.h"
+#include "CPlayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	// Candidate inputs tried at every node: idle, eight directions, fire
+	const SimInput Actions[] =
+	{
+		{ 0,												false },
+		{ CPlayer::DIR_FORWARD,								false },
+		{ CPlayer::DIR_BACKWARD,							false },
+		{ CPlayer::DIR_LEFT,								false },
+		{ CPlayer::DIR_RIGHT,								false },
+		{ CPlayer::DIR_FORWARD  | CPlayer::DIR_LEFT,		false },
+		{ CPlayer::DIR_FORWARD  | CPlayer::DIR_RIGHT,		false },
+		{ CPlayer::DIR_BACKWARD | CPlayer::DIR_LEFT,		false },
+		{ CPlayer::DIR_BACKWARD | CPlayer::DIR_RIGHT,		false },
+		{ 0,												true  },
+	};
+	const int NUM_ACTIONS = sizeof(Actions) / sizeof(Actions[0]);
+
+	typedef std::chrono::steady_clock Clock;
+
+	inline double MsSince( Clock::time_point Start )
+	{
+		return std::chrono::duration<double, std::milli>( Clock::now() - Start ).count();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CAIOpponent () (Constructor)
+// Desc : CAIOpponent Class Constructor
+//-----------------------------------------------------------------------------
+CAIOpponent::CAIOpponent()
+{
+	m_pPool		= NULL;
+	m_nPlayer	= 1;
+	m_fBudgetMs	= 2.0;
+	m_Stats.nNodes		= 0;
+	m_Stats.nDepth		= 0;
+	m_Stats.fThinkMs	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CAIOpponent () (Destructor)
+// Desc : CAIOpponent Class Destructor
+//-----------------------------------------------------------------------------
+CAIOpponent::~CAIOpponent()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init ()
+// Desc : Selects the controlled player and the per tick time budget.
+//-----------------------------------------------------------------------------
+void CAIOpponent::Init( CThreadPool* pPool, int nPlayer, double fBudgetMs )
+{
+	m_pPool		= pPool;
+	m_nPlayer	= nPlayer;
+	m_fBudgetMs	= fBudgetMs;
+
+	m_Beam.reserve( BEAM_WIDTH );
+	m_Children.resize( BEAM_WIDTH * NUM_ACTIONS );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Think ()
+// Desc : Searches from State, assuming the opponent keeps its current input,
+//		and returns the first action of the best line found within budget.
+//		At least one depth is always searched. Rollouts step by the fixed
+//		CSimState::TICK_SECONDS, so the lookahead is the same time span
+//		whatever the frame rate.
+//-----------------------------------------------------------------------------
+SimInput CAIOpponent::Think( const CSimState& State, const SimInput& OpponentInput )
+{
+	Clock::time_point Start = Clock::now();
+	double fLastDepthMs = 0;
+
+	m_Beam.resize( 1 );
+	m_Beam[0].State			= State;
+	m_Beam[0].nRootAction	= 0;
+	m_Beam[0].fScore		= 0;
+
+	m_Stats.nNodes = 0;
+	m_Stats.nDepth = 0;
+
+	for ( int nDepth = 0; nDepth < MAX_DEPTH; ++nDepth )
+	{
+		// Stop if another depth would likely overrun the budget
+		double fElapsed = MsSince( Start );
+		if ( nDepth > 0 && fElapsed + fLastDepthMs > m_fBudgetMs ) break;
+
+		int nChildren = (int)m_Beam.size() * NUM_ACTIONS;
+		if ( (int)m_Children.size() < nChildren ) m_Children.resize( nChildren );
+
+		auto Expand = [&]( int i )
+		{
+			const Node& Parent	= m_Beam[ i / NUM_ACTIONS ];
+			Node&		Child	= m_Children[i];
+			int			nAction	= i % NUM_ACTIONS;
+
+			SimInput Input[2];
+			Input[m_nPlayer]		= Actions[nAction];
+			Input[m_nPlayer ^ 1]	= OpponentInput;
+
+			Child.State = Parent.State;
+			for ( int t = 0; t < TICKS_PER_MOVE; ++t )
+			{
+				Child.State.Step( Input, CSimState::TICK_SECONDS );
+				Input[m_nPlayer].bShoot = false;
+			}
+
+			Child.nRootAction	= ( nDepth == 0 ) ? nAction : Parent.nRootAction;
+			Child.fScore		= Evaluate( Child.State );
+		};
+
+		if ( m_pPool ) m_pPool->ParallelFor( nChildren, Expand );
+		else for ( int i = 0; i < nChildren; ++i ) Expand( i );
+
+		// Keep the best BEAM_WIDTH children for the next depth
+		int nKeep = std::min<int>( BEAM_WIDTH, nChildren );
+		std::partial_sort( m_Children.begin(), m_Children.begin() + nKeep, m_Children.begin() + nChildren,
+			[]( const Node& a, const Node& b ) { return a.fScore > b.fScore; } );
+		m_Beam.assign( m_Children.begin(), m_Children.begin() + nKeep );
+
+		m_Stats.nNodes += nChildren;
+		m_Stats.nDepth  = nDepth + 1;
+		fLastDepthMs    = MsSince( Start ) - fElapsed;
+	}
+
+	m_Stats.fThinkMs = MsSince( Start );
+	return Actions[ m_Beam[0].nRootAction ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : Evaluate () (Private)
+// Desc : Heuristic score of a state from our player's point of view.
+//-----------------------------------------------------------------------------
+float CAIOpponent::Evaluate( const CSimState& State ) const
+{
+	const SimPlayer& Me		= State.Players[m_nPlayer];
+	const SimPlayer& Them	= State.Players[m_nPlayer ^ 1];
+
+	// Lives dominate everything else
+	float fScore = 1000.0f * (float)( Me.Lives - Them.Lives );
+
+	// Line up with the opponent along our firing axis
+	if ( Me.FireX == 0 )	fScore -= 0.5f * std::fabs( Me.x - Them.x );
+	else					fScore -= 0.5f * std::fabs( Me.y - Them.y );
+
+	// Stay clear of incoming bullets
+	for ( int i = 0; i < State.nBullets; ++i )
+	{
+		const SimBullet& b = State.Bullets[i];
+		if ( b.Owner == m_nPlayer ) continue;
+
+		float dx = b.x - Me.x, dy = b.y - Me.y;
+		fScore -= 4000.0f / ( std::sqrt( dx * dx + dy * dy ) + 20.0f );
+	}
+
+	// Ramming costs both of us a life, keep some distance
+	float dx = Me.x - Them.x, dy = Me.y - Them.y;
+	float fDist = std::sqrt( dx * dx + dy * dy );
+	if ( fDist < 200.0f ) fScore -= ( 200.0f - fDist ) * 2.0f;
+
+	return fScore;
+}
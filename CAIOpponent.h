@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// File: CAIOpponent.h
+//
+// Desc: CPU controlled player. Runs a bounded beam search over CSimState
+//	   rollouts, expanding each search depth in parallel on the thread pool
+//	   and stopping when the per tick time budget runs out.
+//-----------------------------------------------------------------------------
+
+#ifndef _CAIOPPONENT_H_
+#define _CAIOPPONENT_H_
+
+//-----------------------------------------------------------------------------
+// CAIOpponent Specific Includes
+//-----------------------------------------------------------------------------
+#include "CSimState.h"
+#include "CThreadPool.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CAIOpponent (Class)
+// Desc : Picks an input for one player each tick.
+//-----------------------------------------------------------------------------
+class CAIOpponent
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		BEAM_WIDTH		= 8,		// Nodes kept per depth
+		MAX_DEPTH		= 8,		// Decisions looked ahead
+		TICKS_PER_MOVE	= 6,		// Steps each decision is held for
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Stats
+	{
+		int		nNodes;			// Rollout nodes expanded last tick
+		int		nDepth;			// Depth reached last tick
+		double	fThinkMs;		// Wall time spent last tick
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CAIOpponent();
+	virtual ~CAIOpponent();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Init( CThreadPool* pPool, int nPlayer, double fBudgetMs );
+	SimInput				Think( const CSimState& State, const SimInput& OpponentInput );
+	const Stats&			GetStats( ) const { return m_Stats; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class.
+	//-------------------------------------------------------------------------
+	struct Node
+	{
+		CSimState	State;
+		int			nRootAction;	// First action on the path to this node
+		float		fScore;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	float					Evaluate( const CSimState& State ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	CThreadPool*			m_pPool;
+	int						m_nPlayer;		// Index of the player we control
+	double					m_fBudgetMs;	// Wall time allowed per Think()
+	Stats					m_Stats;
+
+	std::vector<Node>		m_Beam;			// Reused between ticks, no per tick allocation
+	std::vector<Node>		m_Children;
+};
+
+#endif // _CAIOPPONENT_H_
@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+// File: CAssetLoader.cpp
+//
+// Desc: Startup asset loading as a batch of jobs on the thread pool. Jobs
+//	   name the jobs they must wait for and whether the first frame needs
+//	   them; everything else keeps loading while the game runs.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAssetLoader Specific Includes
+//-----------------------------------------------------------------------------
+#include "CAssetLoader.h"
+
+//-----------------------------------------------------------------------------
+// Name : CAssetLoader () (Constructor)
+// Desc : CAssetLoader Class Constructor
+//-----------------------------------------------------------------------------
+CAssetLoader::CAssetLoader()
+{
+	m_pPool				= NULL;
+	m_nDone				= 0;
+	m_nRequiredLeft		= 0;
+	m_bRequiredFailed	= false;
+	m_nLastDone			= -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CAssetLoader () (Destructor)
+// Desc : CAssetLoader Class Destructor
+//-----------------------------------------------------------------------------
+CAssetLoader::~CAssetLoader()
+{
+	WaitAll();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+// Desc : Adds a job before Start. Deps are indices returned by earlier Adds,
+//		which keeps the graph acyclic by construction.
+//-----------------------------------------------------------------------------
+int CAssetLoader::Add( const char* szName, const Work& Fn, bool bRequired, std::initializer_list<int> Deps )
+{
+	int nJob = (int)m_Jobs.size();
+
+	m_Jobs.emplace_back();
+	Job& j = m_Jobs.back();
+	j.Name		= szName;
+	j.Run		= Fn;
+	j.bRequired	= bRequired;
+	j.bMustSucceed	= bRequired;
+	j.Deps.assign( Deps.begin(), Deps.end() );
+	j.nWaiting	= (int)j.Deps.size();
+	j.nState	= STATE_PENDING;
+
+	for ( int nDep : Deps ) m_Jobs[nDep].Dependents.push_back( nJob );
+
+	return nJob;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+// Desc : Queues every job without dependencies, the rest follow as their
+//		dependencies complete.
+//-----------------------------------------------------------------------------
+void CAssetLoader::Start( CThreadPool* pPool )
+{
+	m_pPool = pPool;
+
+	for ( size_t i = 0; i < m_Jobs.size(); ++i )
+		if ( m_Jobs[i].bRequired ) RequireDeps( (int)i );
+
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+		m_nRequiredLeft = 0;
+		for ( size_t i = 0; i < m_Jobs.size(); ++i )
+			if ( m_Jobs[i].bRequired ) ++m_nRequiredLeft;
+	}
+
+	// Collect roots first, inline execution (pool not started) would
+	// otherwise release dependents while we are still iterating
+	std::vector<int> Roots;
+	for ( size_t i = 0; i < m_Jobs.size(); ++i )
+		if ( m_Jobs[i].Deps.empty() ) Roots.push_back( (int)i );
+
+	for ( int nJob : Roots )
+		m_pPool->Submit( [this, nJob] { Execute( nJob ); } );
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitRequired ()
+// Desc : Blocks until every required job has finished, reporting progress
+//		on the calling thread. Progress also runs at least every
+//		PROGRESS_MS with an unchanged count, so the caller can keep its
+//		window responsive. Returns false if a required job failed.
+//-----------------------------------------------------------------------------
+bool CAssetLoader::WaitRequired( const ProgressCallback& Progress )
+{
+	std::unique_lock<std::mutex> Lock( m_Mutex );
+
+	int nReported = -1;
+	for (;;)
+	{
+		int nDone = m_nDone.load();
+		nReported = nDone;
+		if ( Progress )
+		{
+			const char* szLast = ( m_nLastDone >= 0 ) ? m_Jobs[m_nLastDone].Name.c_str() : "";
+
+			Lock.unlock();
+			Progress( nDone, (int)m_Jobs.size(), szLast );
+			Lock.lock();
+		}
+
+		if ( m_nRequiredLeft == 0 ) break;
+		m_cvDone.wait_for( Lock, std::chrono::milliseconds( PROGRESS_MS ),
+						   [&] { return m_nDone.load() != nReported || m_nRequiredLeft == 0; } );
+	}
+
+	return !m_bRequiredFailed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitAll ()
+// Desc : Blocks until the whole batch has finished.
+//-----------------------------------------------------------------------------
+void CAssetLoader::WaitAll()
+{
+	if ( !m_pPool ) return;
+
+	std::unique_lock<std::mutex> Lock( m_Mutex );
+	m_cvDone.wait( Lock, [this] { return m_nDone.load() == (int)m_Jobs.size(); } );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Waits for the batch and forgets it, ready for another one.
+//-----------------------------------------------------------------------------
+void CAssetLoader::Clear()
+{
+	WaitAll();
+
+	m_Jobs.clear();
+	m_pPool				= NULL;
+	m_nDone				= 0;
+	m_nRequiredLeft		= 0;
+	m_bRequiredFailed	= false;
+	m_nLastDone			= -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RequireDeps () (Private)
+// Desc : Marks everything a required job waits on as required as well.
+//-----------------------------------------------------------------------------
+void CAssetLoader::RequireDeps( int nJob )
+{
+	for ( int nDep : m_Jobs[nJob].Deps )
+	{
+		if ( m_Jobs[nDep].bRequired ) continue;
+		m_Jobs[nDep].bRequired = true;
+		RequireDeps( nDep );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Execute () (Private)
+// Desc : Runs one job on a worker, then queues any dependent that has no
+//		dependencies left.
+//-----------------------------------------------------------------------------
+void CAssetLoader::Execute( int nJob )
+{
+	Job& j = m_Jobs[nJob];
+	bool bOk = j.Run ? j.Run() : true;
+	j.nState = bOk ? STATE_OK : STATE_FAILED;
+
+	for ( int nNext : j.Dependents )
+		if ( --m_Jobs[nNext].nWaiting == 0 )
+			m_pPool->Submit( [this, nNext] { Execute( nNext ); } );
+
+	// Count this job last so WaitAll never returns with dependents unqueued
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+		if ( j.bRequired )
+		{
+			--m_nRequiredLeft;
+			if ( !bOk && j.bMustSucceed ) m_bRequiredFailed = true;
+		}
+		m_nLastDone = nJob;
+		++m_nDone;
+	}
+	m_cvDone.notify_all();
+}
@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+// File: CAssetLoader.h
+//
+// Desc: Startup asset loading as a batch of jobs on the thread pool. Jobs
+//	   name the jobs they must wait for and whether the first frame needs
+//	   them; everything else keeps loading while the game runs.
+//-----------------------------------------------------------------------------
+
+#ifndef _CASSETLOADER_H_
+#define _CASSETLOADER_H_
+
+//-----------------------------------------------------------------------------
+// CAssetLoader Specific Includes
+//-----------------------------------------------------------------------------
+#include "CThreadPool.h"
+#include <deque>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CAssetLoader (Class)
+// Desc : Dependency aware load batch. Dependencies only order jobs, a failed
+//		job still releases its dependents so they can fall back on their own.
+//		Required jobs pull in everything they depend on, but only a failure
+//		of a job added as required fails the wait.
+//-----------------------------------------------------------------------------
+class CAssetLoader
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		PROGRESS_MS		= 16,		// Longest gap between WaitRequired progress calls
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Typedefs
+	//-------------------------------------------------------------------------
+	typedef std::function<bool()>	Work;
+	typedef std::function<void( int nDone, int nTotal, const char* szLast )> ProgressCallback;
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CAssetLoader();
+	virtual ~CAssetLoader();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	int						Add( const char* szName, const Work& Fn, bool bRequired, std::initializer_list<int> Deps = {} );
+	void					Start( CThreadPool* pPool );
+	bool					WaitRequired( const ProgressCallback& Progress );
+	void					WaitAll( );
+	void					Clear( );
+
+	bool					IsDone( int nJob ) const { return m_Jobs[nJob].nState.load() != STATE_PENDING; }
+	bool					Succeeded( int nJob ) const { return m_Jobs[nJob].nState.load() == STATE_OK; }
+	int						GetDoneCount( ) const { return m_nDone.load(); }
+	int						GetJobCount( ) const { return (int)m_Jobs.size(); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Enumerators
+	//-------------------------------------------------------------------------
+	enum STATE
+	{
+		STATE_PENDING,
+		STATE_OK,
+		STATE_FAILED
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class.
+	//-------------------------------------------------------------------------
+	struct Job
+	{
+		std::string			Name;
+		Work				Run;
+		bool				bRequired;		// First frame waits for it
+		bool				bMustSucceed;	// Failing it fails WaitRequired
+		std::vector<int>	Deps;
+		std::vector<int>	Dependents;
+		std::atomic<int>	nWaiting;		// Dependencies not finished yet
+		std::atomic<int>	nState;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					RequireDeps( int nJob );
+	void					Execute( int nJob );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::deque<Job>			m_Jobs;			// Deque so jobs never move once added
+	CThreadPool*			m_pPool;
+	std::atomic<int>		m_nDone;
+	int						m_nRequiredLeft;	// Guarded by m_Mutex
+	bool					m_bRequiredFailed;
+	int						m_nLastDone;		// Most recently finished job
+	std::mutex				m_Mutex;
+	std::condition_variable	m_cvDone;
+};
+
+#endif // _CASSETLOADER_H_
@@ -0,0 +1,257 @@
+//-----------------------------------------------------------------------------
+// File: CAssetPack.cpp
+//
+// Desc: Runtime reader for the single file asset pack written by
+//	   tools/AssetPacker. The pack is memory mapped, stored entries are
+//	   handed out without copying and LZ4 entries are decoded on first use.
+//	   Paths missing from the pack (or no pack at all) fall back to loose
+//	   files so the game still runs from an unpacked data directory.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAssetPack Specific Includes
+//-----------------------------------------------------------------------------
+#include "CAssetPack.h"
+#include "CLZ4Block.h"
+#include "CTelemetry.h"
+#include <fstream>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Name : CAssetPack () (Constructor)
+// Desc : CAssetPack Class Constructor
+//-----------------------------------------------------------------------------
+CAssetPack::CAssetPack()
+{
+	m_hFile		= INVALID_HANDLE_VALUE;
+	m_hMapping	= NULL;
+	m_pBase		= NULL;
+	m_nFileSize	= 0;
+	m_pIndex	= NULL;
+	m_nBuckets	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CAssetPack () (Destructor)
+// Desc : CAssetPack Class Destructor
+//-----------------------------------------------------------------------------
+CAssetPack::~CAssetPack()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open ()
+// Desc : Maps the pack and validates its header and index. Nothing is read
+//		beyond the header here, pages fault in as entries are used.
+//-----------------------------------------------------------------------------
+bool CAssetPack::Open( LPCTSTR szPath )
+{
+	Close();
+
+	m_hFile = CreateFile( szPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL );
+	if ( m_hFile == INVALID_HANDLE_VALUE ) return false;
+	CTelemetry::TrackHandles( CTelemetry::SUB_ASSETS, 1 );
+
+	LARGE_INTEGER Size;
+	if ( !GetFileSizeEx( m_hFile, &Size ) || Size.QuadPart < (LONGLONG)sizeof(PackHeader) ) { Close(); return false; }
+	m_nFileSize = (size_t)Size.QuadPart;
+
+	m_hMapping = CreateFileMapping( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( !m_hMapping ) { Close(); return false; }
+	CTelemetry::TrackHandles( CTelemetry::SUB_ASSETS, 1 );
+
+	m_pBase = (const BYTE*)MapViewOfFile( m_hMapping, FILE_MAP_READ, 0, 0, 0 );
+	if ( !m_pBase ) { Close(); return false; }
+	CTelemetry::TrackHandles( CTelemetry::SUB_ASSETS, 1 );
+
+	const PackHeader* pHeader = (const PackHeader*)m_pBase;
+	if ( memcmp( pHeader->Magic, PACK_MAGIC, 4 ) != 0 || pHeader->Version != PACK_VERSION ) { Close(); return false; }
+
+	// Bucket count must be a power of two and the index must lie in the file
+	uint32_t nBuckets = pHeader->nBuckets;
+	if ( nBuckets == 0 || ( nBuckets & ( nBuckets - 1 ) ) != 0 ) { Close(); return false; }
+	if ( pHeader->IndexOffset > m_nFileSize || ( m_nFileSize - pHeader->IndexOffset ) / sizeof(PackEntry) < nBuckets ) { Close(); return false; }
+
+	m_pIndex	= (const PackEntry*)( m_pBase + pHeader->IndexOffset );
+	m_nBuckets	= nBuckets;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+// Desc : Unmaps the pack and frees every decoded entry.
+//-----------------------------------------------------------------------------
+void CAssetPack::Close()
+{
+	if ( m_pBase )							UnmapViewOfFile( m_pBase );
+	if ( m_hMapping )						CloseHandle( m_hMapping );
+	if ( m_hFile != INVALID_HANDLE_VALUE )	CloseHandle( m_hFile );
+	CTelemetry::TrackHandles( CTelemetry::SUB_ASSETS, -( ( m_pBase != NULL ) + ( m_hMapping != NULL ) + ( m_hFile != INVALID_HANDLE_VALUE ) ) );
+
+	m_hFile		= INVALID_HANDLE_VALUE;
+	m_hMapping	= NULL;
+	m_pBase		= NULL;
+	m_nFileSize	= 0;
+	m_pIndex	= NULL;
+	m_nBuckets	= 0;
+
+	std::lock_guard<std::mutex> Lock( m_CacheLock );
+	m_Cache.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetData ()
+// Desc : Returns the contents of an asset, or NULL if it can not be found.
+//		Stored entries point straight into the mapping; compressed entries
+//		and loose files are decoded / read once and cached. Decoding runs
+//		outside the lock so parallel loaders do not serialise on it.
+//-----------------------------------------------------------------------------
+const BYTE* CAssetPack::GetData( LPCTSTR szPath, size_t& nSize )
+{
+	nSize = 0;
+
+	const PackEntry* pEntry = FindEntry( szPath );
+	if ( pEntry && !( pEntry->Flags & PACK_FLAG_LZ4 ) )
+	{
+		nSize = pEntry->PackedSize;
+		return m_pBase + pEntry->Offset;
+	}
+
+	uint64_t nHash = HashAssetPath( szPath );
+	{
+		std::lock_guard<std::mutex> Lock( m_CacheLock );
+		auto it = m_Cache.find( nHash );
+		if ( it != m_Cache.end() ) { nSize = it->second.size(); return it->second.empty() ? NULL : &it->second[0]; }
+	}
+
+	std::vector<BYTE> Data;
+	if ( pEntry )
+	{
+		Data.resize( pEntry->Size );
+		if ( !CLZ4Block::Decompress( m_pBase + pEntry->Offset, pEntry->PackedSize, Data.empty() ? NULL : &Data[0], Data.size() ) ) return NULL;
+	}
+	else if ( !ReadLooseFile( szPath, Data ) ) return NULL;
+
+	// Another thread may have got here first, keep whichever copy landed
+	std::lock_guard<std::mutex> Lock( m_CacheLock );
+	std::vector<BYTE>& Cached = m_Cache.emplace( nHash, std::move( Data ) ).first->second;
+	nSize = Cached.size();
+	return Cached.empty() ? NULL : &Cached[0];
+}
+
+//-----------------------------------------------------------------------------
+// Name : DecodeBitmap ()
+// Desc : Decodes a 24 / 32 bit .bmp asset to 32 bit pixels, see CBmpDecoder.
+//-----------------------------------------------------------------------------
+bool CAssetPack::DecodeBitmap( LPCTSTR szPath, CBmpDecoder::Image& Out, uint32_t nColorKey )
+{
+	size_t nSize;
+	const BYTE* pData = GetData( szPath, nSize );
+	if ( !pData ) return false;
+
+	return CBmpDecoder::Decode( pData, nSize, Out, nColorKey );
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadBitmapAsset ()
+// Desc : Creates a device compatible bitmap from a .bmp asset, the same
+//		result LoadImage(LR_LOADFROMFILE) gives for a loose file. Formats
+//		CBmpDecoder does not handle go through GDI's own conversion.
+//-----------------------------------------------------------------------------
+HBITMAP CAssetPack::LoadBitmapAsset( LPCTSTR szPath, HDC hdcRef )
+{
+	size_t nSize;
+	const BYTE* pData = GetData( szPath, nSize );
+	if ( !pData ) return NULL;
+
+	CBmpDecoder::Image Image;
+	if ( CBmpDecoder::Decode( pData, nSize, Image ) ) return CreateBitmapFromImage( Image, hdcRef );
+
+	if ( nSize < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER) ) return NULL;
+
+	const BITMAPFILEHEADER* pFile = (const BITMAPFILEHEADER*)pData;
+	const BITMAPINFO*		pInfo = (const BITMAPINFO*)( pData + sizeof(BITMAPFILEHEADER) );
+	if ( pFile->bfType != 0x4D42 || pFile->bfOffBits >= nSize ) return NULL;
+
+	return CreateDIBitmap( hdcRef, &pInfo->bmiHeader, CBM_INIT, pData + pFile->bfOffBits, pInfo, DIB_RGB_COLORS );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CreateBitmapFromImage () (Static)
+// Desc : Device compatible bitmap from decoded 32 bit pixels.
+//-----------------------------------------------------------------------------
+HBITMAP CAssetPack::CreateBitmapFromImage( const CBmpDecoder::Image& Image, HDC hdcRef )
+{
+	if ( Image.Pixels.empty() ) return NULL;
+
+	BITMAPINFO bmi;
+	memset( &bmi, 0, sizeof(bmi) );
+	bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		= Image.nWidth;
+	bmi.bmiHeader.biHeight		= -Image.nHeight;		// Top down
+	bmi.bmiHeader.biPlanes		= 1;
+	bmi.bmiHeader.biBitCount	= 32;
+	bmi.bmiHeader.biCompression	= BI_RGB;
+
+	return CreateDIBitmap( hdcRef, &bmi.bmiHeader, CBM_INIT, &Image.Pixels[0], &bmi, DIB_RGB_COLORS );
+}
+
+//-----------------------------------------------------------------------------
+// Name : PlaySoundAsset ()
+// Desc : Plays a .wav asset from memory. The data stays cached until Close
+//		so asynchronous playback never outlives its buffer.
+//-----------------------------------------------------------------------------
+bool CAssetPack::PlaySoundAsset( LPCTSTR szPath, DWORD Flags )
+{
+	size_t nSize;
+	const BYTE* pData = GetData( szPath, nSize );
+	if ( !pData ) return false;
+
+	return ::PlaySound( (LPCTSTR)pData, NULL, Flags | SND_MEMORY ) != FALSE;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FindEntry () (Private)
+// Desc : Linear probe of the index for the path's hash.
+//-----------------------------------------------------------------------------
+const PackEntry* CAssetPack::FindEntry( LPCTSTR szPath ) const
+{
+	if ( !m_pIndex ) return NULL;
+
+	uint64_t nHash	 = HashAssetPath( szPath );
+	uint32_t nBucket = (uint32_t)nHash & ( m_nBuckets - 1 );
+
+	for ( uint32_t nProbe = 0; nProbe < m_nBuckets; ++nProbe )
+	{
+		const PackEntry* pEntry = &m_pIndex[nBucket];
+		if ( pEntry->Hash == 0 ) return NULL;
+		if ( pEntry->Hash == nHash )
+		{
+			// Reject entries pointing outside the file rather than faulting later.
+			// Stored entries are handed out as is, so their size must be the
+			// bytes actually stored
+			if ( pEntry->Offset > m_nFileSize || m_nFileSize - pEntry->Offset < pEntry->PackedSize ) return NULL;
+			if ( !( pEntry->Flags & PACK_FLAG_LZ4 ) && pEntry->Size != pEntry->PackedSize ) return NULL;
+			return pEntry;
+		}
+		nBucket = ( nBucket + 1 ) & ( m_nBuckets - 1 );
+	}
+
+	return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadLooseFile () (Private)
+// Desc : Fallback for assets that are not in the pack.
+//-----------------------------------------------------------------------------
+bool CAssetPack::ReadLooseFile( LPCTSTR szPath, std::vector<BYTE>& Out ) const
+{
+	std::ifstream File( szPath, std::ios::binary | std::ios::ate );
+	if ( !File ) return false;
+
+	std::streamoff nSize = File.tellg();
+	File.seekg( 0 );
+	Out.resize( (size_t)nSize );
+	return nSize == 0 || (bool)File.read( (char*)&Out[0], nSize );
+}
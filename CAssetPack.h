@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// File: CAssetPack.h
+//
+// Desc: Runtime reader for the single file asset pack written by
+//	   tools/AssetPacker. The pack is memory mapped, stored entries are
+//	   handed out without copying and LZ4 entries are decoded on first use.
+//	   Paths missing from the pack (or no pack at all) fall back to loose
+//	   files so the game still runs from an unpacked data directory.
+//-----------------------------------------------------------------------------
+
+#ifndef _CASSETPACK_H_
+#define _CASSETPACK_H_
+
+//-----------------------------------------------------------------------------
+// CAssetPack Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "AssetPackFormat.h"
+#include "CBmpDecoder.h"
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CAssetPack (Class)
+// Desc : Read only view of an asset pack. GetData may be called from several
+//		threads at once; the returned memory stays valid until Close.
+//-----------------------------------------------------------------------------
+class CAssetPack
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CAssetPack();
+	virtual ~CAssetPack();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Open( LPCTSTR szPath );
+	void					Close( );
+	bool					IsOpen( ) const { return m_pBase != NULL; }
+
+	bool					Contains( LPCTSTR szPath ) const { return FindEntry( szPath ) != NULL; }
+	const BYTE*				GetData( LPCTSTR szPath, size_t& nSize );
+
+	bool					DecodeBitmap( LPCTSTR szPath, CBmpDecoder::Image& Out, uint32_t nColorKey = CBmpDecoder::NO_COLOR_KEY );
+	HBITMAP					LoadBitmapAsset( LPCTSTR szPath, HDC hdcRef );
+	bool					PlaySoundAsset( LPCTSTR szPath, DWORD Flags = SND_ASYNC );
+
+	static HBITMAP			CreateBitmapFromImage( const CBmpDecoder::Image& Image, HDC hdcRef );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	const PackEntry*		FindEntry( LPCTSTR szPath ) const;
+	bool					ReadLooseFile( LPCTSTR szPath, std::vector<BYTE>& Out ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	HANDLE					m_hFile;
+	HANDLE					m_hMapping;
+	const BYTE*				m_pBase;			// Mapped view of the whole pack
+	size_t					m_nFileSize;
+	const PackEntry*		m_pIndex;
+	uint32_t				m_nBuckets;
+
+	std::mutex				m_CacheLock;
+	std::unordered_map<uint64_t, std::vector<BYTE> > m_Cache;	// Decoded and loose file data by path hash
+};
+
+#endif // _CASSETPACK_H_
@@ -0,0 +1,259 @@
+//-----------------------------------------------------------------------------
+// File: CBmpDecoder.cpp
+//
+// Desc: Platform independent decoder for the uncompressed 24 and 32 bit
+//	   Windows bitmaps the game ships. Decodes from memory straight into
+//	   the renderer's native 32 bit layout (0xAARRGGBB, top down), folding
+//	   an optional colour key into alpha. Rows are converted with SSE2 /
+//	   SSSE3 where the CPU has it.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBmpDecoder Specific Includes
+//-----------------------------------------------------------------------------
+#include "CBmpDecoder.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define BMP_X86
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define BMP_TARGET_SSE2
+		#define BMP_TARGET_SSSE3
+	#else
+		#include <cpuid.h>
+		#define BMP_TARGET_SSE2		__attribute__((target("sse2")))
+		#define BMP_TARGET_SSSE3	__attribute__((target("ssse3")))
+	#endif
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Constants and Helpers
+//-----------------------------------------------------------------------------
+namespace
+{
+	const size_t	FILE_HEADER_SIZE	= 14;
+	const uint32_t	BMP_BI_RGB			= 0;
+	const uint32_t	BMP_BI_BITFIELDS	= 3;
+	const int		MAX_DIMENSION		= 32768;
+	const uint32_t	RGB_MASK			= 0x00FFFFFF;
+	const uint32_t	ALPHA_OPAQUE		= 0xFF000000;
+
+	// Header fields are little endian whatever the host is
+	inline uint32_t Read16( const unsigned char* p ) { return p[0] | ( p[1] << 8 ); }
+	inline uint32_t Read32( const unsigned char* p ) { return (uint32_t)p[0] | ( (uint32_t)p[1] << 8 ) | ( (uint32_t)p[2] << 16 ) | ( (uint32_t)p[3] << 24 ); }
+
+	inline uint32_t ApplyKey( uint32_t Rgb, uint32_t nColorKey ) { return Rgb | ( Rgb == nColorKey ? 0 : ALPHA_OPAQUE ); }
+
+#ifdef BMP_X86
+	bool DetectSSE2()
+	{
+	#if defined(_M_X64) || defined(__x86_64__)
+		return true;
+	#elif defined(_MSC_VER)
+		int Regs[4];
+		__cpuid( Regs, 1 );
+		return ( Regs[3] & ( 1 << 26 ) ) != 0;
+	#else
+		unsigned int a, b, c, d;
+		return __get_cpuid( 1, &a, &b, &c, &d ) && ( d & ( 1 << 26 ) );
+	#endif
+	}
+
+	bool DetectSSSE3()
+	{
+	#if defined(_MSC_VER)
+		int Regs[4];
+		__cpuid( Regs, 1 );
+		return ( Regs[2] & ( 1 << 9 ) ) != 0;
+	#else
+		unsigned int a, b, c, d;
+		return __get_cpuid( 1, &a, &b, &c, &d ) && ( c & ( 1 << 9 ) );
+	#endif
+	}
+
+	const bool		g_bHasSSE2		= DetectSSE2();
+	const bool		g_bHasSSSE3		= DetectSSSE3();
+
+	// Four pixels per step, the caller guarantees 16 readable source bytes
+	BMP_TARGET_SSSE3 int ConvertRow24SSSE3( const unsigned char* pSrc, uint32_t* pDst, int nCount, size_t nSrcAvail, uint32_t nColorKey )
+	{
+		const __m128i Shuffle	= _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+		const __m128i Alpha		= _mm_set1_epi32( (int)ALPHA_OPAQUE );
+		const __m128i Key		= _mm_set1_epi32( (int)nColorKey );
+
+		int x = 0;
+		for ( ; x + 4 <= nCount && (size_t)x * 3 + 16 <= nSrcAvail; x += 4 )
+		{
+			__m128i Rgb = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)( pSrc + x * 3 ) ), Shuffle );
+			__m128i a	= _mm_andnot_si128( _mm_cmpeq_epi32( Rgb, Key ), Alpha );
+			_mm_storeu_si128( (__m128i*)( pDst + x ), _mm_or_si128( Rgb, a ) );
+		}
+		return x;
+	}
+
+	BMP_TARGET_SSE2 int ConvertRow32SSE2( const unsigned char* pSrc, uint32_t* pDst, int nCount, uint32_t nColorKey )
+	{
+		const __m128i Mask	= _mm_set1_epi32( (int)RGB_MASK );
+		const __m128i Alpha	= _mm_set1_epi32( (int)ALPHA_OPAQUE );
+		const __m128i Key	= _mm_set1_epi32( (int)nColorKey );
+
+		int x = 0;
+		for ( ; x + 4 <= nCount; x += 4 )
+		{
+			__m128i Rgb = _mm_and_si128( _mm_loadu_si128( (const __m128i*)( pSrc + x * 4 ) ), Mask );
+			__m128i a	= _mm_andnot_si128( _mm_cmpeq_epi32( Rgb, Key ), Alpha );
+			_mm_storeu_si128( (__m128i*)( pDst + x ), _mm_or_si128( Rgb, a ) );
+		}
+		return x;
+	}
+#else
+	const bool		g_bHasSSE2		= false;
+	const bool		g_bHasSSSE3		= false;
+#endif
+
+	bool			g_bUseSIMD		= true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadInfo () (Static)
+// Desc : Validates the headers and works out where the rows are. Anything
+//		other than uncompressed 24 / 32 bit (or 32 bit with the standard
+//		8-8-8 bit fields) is rejected so callers can fall back to GDI.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::ReadInfo( const unsigned char* pData, size_t nSize, Info& Out )
+{
+	if ( !pData || nSize < FILE_HEADER_SIZE + 40 ) return false;
+	if ( pData[0] != 'B' || pData[1] != 'M' ) return false;
+
+	const unsigned char* pInfo = pData + FILE_HEADER_SIZE;
+	uint32_t nHeaderSize	= Read32( pInfo );
+	int32_t	 nWidth			= (int32_t)Read32( pInfo + 4 );
+	int32_t	 nHeight		= (int32_t)Read32( pInfo + 8 );
+	uint32_t nPlanes		= Read16( pInfo + 12 );
+	uint32_t nBitCount		= Read16( pInfo + 14 );
+	uint32_t nCompression	= Read32( pInfo + 16 );
+
+	if ( nHeaderSize < 40 || nPlanes != 1 ) return false;
+	if ( nBitCount != 24 && nBitCount != 32 ) return false;
+	if ( nWidth <= 0 || nWidth > MAX_DIMENSION || nHeight == 0 || nHeight < -MAX_DIMENSION || nHeight > MAX_DIMENSION ) return false;
+
+	if ( nCompression == BMP_BI_BITFIELDS )
+	{
+		// Masks follow a 40 byte header and sit at the same place in V4 / V5
+		if ( nBitCount != 32 || nSize < FILE_HEADER_SIZE + 52 ) return false;
+		if ( Read32( pInfo + 40 ) != 0x00FF0000 || Read32( pInfo + 44 ) != 0x0000FF00 || Read32( pInfo + 48 ) != 0x000000FF ) return false;
+	}
+	else if ( nCompression != BMP_BI_RGB ) return false;
+
+	Out.nWidth			= nWidth;
+	Out.nHeight			= nHeight < 0 ? -nHeight : nHeight;
+	Out.nBitCount		= (int)nBitCount;
+	Out.bTopDown		= nHeight < 0;
+	Out.nPixelOffset	= Read32( pData + 10 );
+	Out.nStride			= ( ( (size_t)nWidth * nBitCount + 31 ) / 32 ) * 4;
+
+	if ( Out.nPixelOffset > nSize || ( nSize - Out.nPixelOffset ) / Out.nStride < (size_t)Out.nHeight ) return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Decode () (Static)
+// Desc : Decodes into a newly sized image.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::Decode( const unsigned char* pData, size_t nSize, Image& Out, uint32_t nColorKey )
+{
+	Info BmpInfo;
+	if ( !ReadInfo( pData, nSize, BmpInfo ) ) return false;
+
+	Out.nWidth	= BmpInfo.nWidth;
+	Out.nHeight	= BmpInfo.nHeight;
+	Out.Pixels.resize( (size_t)BmpInfo.nWidth * BmpInfo.nHeight );
+
+	return Decode( pData, nSize, &Out.Pixels[0], BmpInfo.nWidth, nColorKey );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Decode () (Static)
+// Desc : Decodes into caller memory, e.g. the bits of a DIB section.
+//		nDestPitch is in pixels; rows are written top down.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::Decode( const unsigned char* pData, size_t nSize, uint32_t* pDest, size_t nDestPitch, uint32_t nColorKey )
+{
+	Info BmpInfo;
+	if ( !ReadInfo( pData, nSize, BmpInfo ) ) return false;
+
+	// Key is compared against the RGB bits only
+	if ( nColorKey != NO_COLOR_KEY ) nColorKey &= RGB_MASK;
+
+	const unsigned char* pRows	= pData + BmpInfo.nPixelOffset;
+	const unsigned char* pEnd	= pData + nSize;
+
+	for ( int y = 0; y < BmpInfo.nHeight; ++y )
+	{
+		int nSrcRow = BmpInfo.bTopDown ? y : BmpInfo.nHeight - 1 - y;
+		const unsigned char* pSrc = pRows + (size_t)nSrcRow * BmpInfo.nStride;
+		uint32_t* pDst = pDest + (size_t)y * nDestPitch;
+
+		if ( BmpInfo.nBitCount == 24 )
+			ConvertRow24( pSrc, pDst, BmpInfo.nWidth, (size_t)( pEnd - pSrc ), nColorKey );
+		else
+			ConvertRow32( pSrc, pDst, BmpInfo.nWidth, nColorKey );
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : HasSIMD () (Static)
+// Desc : True if the SIMD row converters are available and enabled.
+//-----------------------------------------------------------------------------
+bool CBmpDecoder::HasSIMD()
+{
+	return g_bUseSIMD && g_bHasSSE2;
+}
+
+//-----------------------------------------------------------------------------
+// Name : EnableSIMD () (Static)
+// Desc : Switches the SIMD row converters on or off. Not thread safe, set it
+//		before decoding starts.
+//-----------------------------------------------------------------------------
+void CBmpDecoder::EnableSIMD( bool bEnable )
+{
+	g_bUseSIMD = bEnable;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ConvertRow24 () (Private, Static)
+// Desc : BGR triplets to 0xAARRGGBB. nSrcAvail bounds how far the SIMD loop
+//		may read, since it loads 16 bytes to use 12.
+//-----------------------------------------------------------------------------
+void CBmpDecoder::ConvertRow24( const unsigned char* pSrc, uint32_t* pDst, int nCount, size_t nSrcAvail, uint32_t nColorKey )
+{
+	int x = 0;
+#ifdef BMP_X86
+	if ( g_bUseSIMD && g_bHasSSSE3 ) x = ConvertRow24SSSE3( pSrc, pDst, nCount, nSrcAvail, nColorKey );
+#endif
+
+	for ( ; x < nCount; ++x )
+	{
+		const unsigned char* p = pSrc + x * 3;
+		pDst[x] = ApplyKey( p[0] | ( p[1] << 8 ) | ( (uint32_t)p[2] << 16 ), nColorKey );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ConvertRow32 () (Private, Static)
+// Desc : BGRX quads to 0xAARRGGBB, the stored fourth byte is ignored.
+//-----------------------------------------------------------------------------
+void CBmpDecoder::ConvertRow32( const unsigned char* pSrc, uint32_t* pDst, int nCount, uint32_t nColorKey )
+{
+	int x = 0;
+#ifdef BMP_X86
+	if ( g_bUseSIMD && g_bHasSSE2 ) x = ConvertRow32SSE2( pSrc, pDst, nCount, nColorKey );
+#endif
+
+	for ( ; x < nCount; ++x )
+		pDst[x] = ApplyKey( Read32( pSrc + x * 4 ) & RGB_MASK, nColorKey );
+}
@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// File: CBmpDecoder.h
+//
+// Desc: Platform independent decoder for the uncompressed 24 and 32 bit
+//	   Windows bitmaps the game ships. Decodes from memory straight into
+//	   the renderer's native 32 bit layout (0xAARRGGBB, top down), folding
+//	   an optional colour key into alpha. Rows are converted with SSE2 /
+//	   SSSE3 where the CPU has it.
+//-----------------------------------------------------------------------------
+
+#ifndef _CBMPDECODER_H_
+#define _CBMPDECODER_H_
+
+//-----------------------------------------------------------------------------
+// CBmpDecoder Specific Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBmpDecoder (Class)
+// Desc : Stateless BMP decode. Alpha is 0 where a pixel matches the colour
+//		key and 0xFF everywhere else.
+//-----------------------------------------------------------------------------
+class CBmpDecoder
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	static const uint32_t	NO_COLOR_KEY = 0xFFFFFFFF;
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Info
+	{
+		int					nWidth;
+		int					nHeight;
+		int					nBitCount;		// 24 or 32
+		bool				bTopDown;
+		size_t				nPixelOffset;	// Start of the pixel rows in the file
+		size_t				nStride;		// Bytes per stored row
+	};
+
+	struct Image
+	{
+		int					nWidth;
+		int					nHeight;
+		std::vector<uint32_t> Pixels;		// nWidth * nHeight, top down
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class.
+	//-------------------------------------------------------------------------
+	static bool				ReadInfo( const unsigned char* pData, size_t nSize, Info& Out );
+	static bool				Decode( const unsigned char* pData, size_t nSize, Image& Out, uint32_t nColorKey = NO_COLOR_KEY );
+	static bool				Decode( const unsigned char* pData, size_t nSize, uint32_t* pDest, size_t nDestPitch, uint32_t nColorKey = NO_COLOR_KEY );
+
+	// Colour key from a GDI COLORREF (0x00BBGGRR) to our 0x00RRGGBB
+	static uint32_t			KeyFromCOLORREF( uint32_t Color ) { return ( ( Color & 0xFF ) << 16 ) | ( Color & 0xFF00 ) | ( ( Color >> 16 ) & 0xFF ); }
+
+	// SIMD can be switched off to compare against the scalar path
+	static bool				HasSIMD( );
+	static void				EnableSIMD( bool bEnable );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Static Functions for This Class.
+	//-------------------------------------------------------------------------
+	static void				ConvertRow24( const unsigned char* pSrc, uint32_t* pDst, int nCount, size_t nSrcAvail, uint32_t nColorKey );
+	static void				ConvertRow32( const unsigned char* pSrc, uint32_t* pDst, int nCount, uint32_t nColorKey );
+};
+
+#endif // _CBMPDECODER_H_
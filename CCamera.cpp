@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// File: CCamera.cpp
+//
+// Desc: Camera / world bounds subsystem. Tracks the client viewport (fed from
+//	   WM_SIZE), the rectangle of the world that entities may live in and
+//	   provides the visibility and bounds tests used for culling / despawning.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCamera Specific Includes
+//-----------------------------------------------------------------------------
+#include "CCamera.h"
+
+//-----------------------------------------------------------------------------
+// Name : CCamera () (Constructor)
+// Desc : CCamera Class Constructor
+//-----------------------------------------------------------------------------
+CCamera::CCamera()
+{
+	m_rcView.left	= m_rcView.top		= 0;
+	m_rcView.right	= m_rcView.bottom	= 0;
+	m_rcWorld		= m_rcView;
+	m_bWorldIsView	= true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CCamera () (Destructor)
+// Desc : CCamera Class Destructor
+//-----------------------------------------------------------------------------
+CCamera::~CCamera()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetViewport ()
+// Desc : Called with the new client size whenever the window is resized.
+//		Unless explicit world bounds were set, the world is the view.
+//-----------------------------------------------------------------------------
+void CCamera::SetViewport( ULONG nWidth, ULONG nHeight )
+{
+	m_rcView.right	= m_rcView.left + (LONG)nWidth;
+	m_rcView.bottom	= m_rcView.top  + (LONG)nHeight;
+
+	if ( m_bWorldIsView )
+	{
+		m_rcWorld.left		= 0;
+		m_rcWorld.top		= 0;
+		m_rcWorld.right		= (LONG)nWidth;
+		m_rcWorld.bottom	= (LONG)nHeight;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetWorldBounds ()
+// Desc : Fixes the world rectangle, it no longer follows the viewport.
+//-----------------------------------------------------------------------------
+void CCamera::SetWorldBounds( const RECT& rcWorld )
+{
+	m_rcWorld		= rcWorld;
+	m_bWorldIsView	= false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsVisible ()
+// Desc : Does a nWidth x nHeight box centred on Centre overlap the view ?
+//-----------------------------------------------------------------------------
+bool CCamera::IsVisible( const Vec2& Centre, int nWidth, int nHeight ) const
+{
+	double fHalfW = nWidth  * 0.5;
+	double fHalfH = nHeight * 0.5;
+
+	return Centre.x + fHalfW > m_rcView.left && Centre.x - fHalfW < m_rcView.right &&
+		   Centre.y + fHalfH > m_rcView.top  && Centre.y - fHalfH < m_rcView.bottom;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsInWorld ()
+// Desc : Does a nWidth x nHeight box centred on Centre overlap the world ?
+//-----------------------------------------------------------------------------
+bool CCamera::IsInWorld( const Vec2& Centre, int nWidth, int nHeight ) const
+{
+	double fHalfW = nWidth  * 0.5;
+	double fHalfH = nHeight * 0.5;
+
+	return Centre.x + fHalfW > m_rcWorld.left && Centre.x - fHalfW < m_rcWorld.right &&
+		   Centre.y + fHalfH > m_rcWorld.top  && Centre.y - fHalfH < m_rcWorld.bottom;
+}
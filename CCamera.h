@@ -0,0 +1,58 @@
+//-----------------------------------------------------------------------------
+// File: CCamera.h
+//
+// Desc: Camera / world bounds subsystem. Tracks the client viewport (fed from
+//	   WM_SIZE), the rectangle of the world that entities may live in and
+//	   provides the visibility and bounds tests used for culling / despawning.
+//-----------------------------------------------------------------------------
+
+#ifndef _CCAMERA_H_
+#define _CCAMERA_H_
+
+//-----------------------------------------------------------------------------
+// CCamera Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCamera (Class)
+// Desc : View rectangle in world space plus the world bounds. The view is
+//		pinned to the world origin, so world and client coordinates are the
+//		same and draws use world positions directly.
+//-----------------------------------------------------------------------------
+class CCamera
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CCamera();
+	virtual ~CCamera();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					SetViewport( ULONG nWidth, ULONG nHeight );
+	void					SetWorldBounds( const RECT& rcWorld );
+
+	const RECT&				GetViewRect( ) const	{ return m_rcView; }
+	const RECT&				GetWorldBounds( ) const	{ return m_rcWorld; }
+	ULONG					GetWorldWidth( ) const	{ return m_rcWorld.right - m_rcWorld.left; }
+	ULONG					GetWorldHeight( ) const	{ return m_rcWorld.bottom - m_rcWorld.top; }
+
+	bool					IsVisible( const Vec2& Centre, int nWidth, int nHeight ) const;
+	bool					IsInWorld( const Vec2& Centre, int nWidth, int nHeight ) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	RECT					m_rcView;		// Visible part of the world
+	RECT					m_rcWorld;		// Entities outside this are despawned
+	bool					m_bWorldIsView;	// World bounds follow viewport resizes
+};
+
+#endif // _CCAMERA_H_
@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// File: CCollisionMask.cpp
+//
+// Desc: One bit per pixel solidity mask for pixel perfect collision. Built
+//	   once at load time; tested only after a bounding box hit, 64 pixels
+//	   at a time with shifted ANDs.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include "CCollisionMask.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Name : CCollisionMask () (Constructor)
+// Desc : CCollisionMask Class Constructor
+//-----------------------------------------------------------------------------
+CCollisionMask::CCollisionMask()
+{
+	m_nWidth	= 0;
+	m_nHeight	= 0;
+	m_nWords	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CCollisionMask () (Destructor)
+// Desc : CCollisionMask Class Destructor
+//-----------------------------------------------------------------------------
+CCollisionMask::~CCollisionMask()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromAlpha ()
+// Desc : Builds the mask from 32 bit pixels, solid where alpha is set.
+//		nPitch is in pixels.
+//-----------------------------------------------------------------------------
+void CCollisionMask::BuildFromAlpha( const uint32_t* pPixels, size_t nPitch, int nWidth, int nHeight )
+{
+	Resize( nWidth, nHeight );
+
+	for ( int y = 0; y < nHeight; ++y )
+	{
+		const uint32_t* pRow  = pPixels + (size_t)y * nPitch;
+		uint64_t*		pBits = &m_Bits[(size_t)y * m_nWords];
+		for ( int x = 0; x < nWidth; ++x )
+			if ( pRow[x] & 0xFF000000 ) pBits[x >> 6] |= (uint64_t)1 << ( x & 63 );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromMask ()
+// Desc : Builds the mask from a decoded SRCAND mask, solid where black.
+//		nPitch is in pixels.
+//-----------------------------------------------------------------------------
+void CCollisionMask::BuildFromMask( const uint32_t* pPixels, size_t nPitch, int nWidth, int nHeight )
+{
+	Resize( nWidth, nHeight );
+
+	for ( int y = 0; y < nHeight; ++y )
+	{
+		const uint32_t* pRow  = pPixels + (size_t)y * nPitch;
+		uint64_t*		pBits = &m_Bits[(size_t)y * m_nWords];
+		for ( int x = 0; x < nWidth; ++x )
+			if ( ( pRow[x] & 0x00FFFFFF ) == 0 ) pBits[x >> 6] |= (uint64_t)1 << ( x & 63 );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the bits.
+//-----------------------------------------------------------------------------
+void CCollisionMask::Release()
+{
+	m_Bits.clear();
+	m_nWidth	= 0;
+	m_nHeight	= 0;
+	m_nWords	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsSolid ()
+// Desc : Single pixel lookup, false outside the mask.
+//-----------------------------------------------------------------------------
+bool CCollisionMask::IsSolid( int x, int y ) const
+{
+	if ( x < 0 || y < 0 || x >= m_nWidth || y >= m_nHeight ) return false;
+	return ( m_Bits[(size_t)y * m_nWords + ( x >> 6 )] >> ( x & 63 ) ) & 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Overlap () (Static)
+// Desc : True if any solid pixel of A lands on a solid pixel of B. Each row
+//		of the intersection is compared a word at a time; a mask that was
+//		never built counts as fully solid so callers keep their box test.
+//-----------------------------------------------------------------------------
+bool CCollisionMask::Overlap( const CCollisionMask& A, int ax, int ay, const CCollisionMask& B, int bx, int by )
+{
+	if ( A.IsEmpty() || B.IsEmpty() ) return true;
+
+	int x0 = std::max( ax, bx );
+	int x1 = std::min( ax + A.m_nWidth, bx + B.m_nWidth );
+	int y0 = std::max( ay, by );
+	int y1 = std::min( ay + A.m_nHeight, by + B.m_nHeight );
+	if ( x0 >= x1 || y0 >= y1 ) return false;
+
+	// Whichever mask ends at x1 has only zero bits beyond it, so the last
+	// word of a row needs no tail mask
+	for ( int y = y0; y < y1; ++y )
+	{
+		for ( int x = x0; x < x1; x += 64 )
+			if ( A.ReadBits( y - ay, x - ax ) & B.ReadBits( y - by, x - bx ) ) return true;
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Resize () (Private)
+// Desc : Allocates a cleared mask.
+//-----------------------------------------------------------------------------
+void CCollisionMask::Resize( int nWidth, int nHeight )
+{
+	m_nWidth	= nWidth;
+	m_nHeight	= nHeight;
+	m_nWords	= ( nWidth + 63 ) / 64 + 1;
+	m_Bits.assign( (size_t)m_nWords * nHeight, 0 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadBits () (Private)
+// Desc : The 64 pixels of row y starting at x, x in [0, width).
+//-----------------------------------------------------------------------------
+uint64_t CCollisionMask::ReadBits( int y, int x ) const
+{
+	const uint64_t* pRow  = &m_Bits[(size_t)y * m_nWords + ( x >> 6 )];
+	int				nShift = x & 63;
+
+	if ( nShift == 0 ) return pRow[0];
+	return ( pRow[0] >> nShift ) | ( pRow[1] << ( 64 - nShift ) );
+}
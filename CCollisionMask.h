@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// File: CCollisionMask.h
+//
+// Desc: One bit per pixel solidity mask for pixel perfect collision. Built
+//	   once at load time; tested only after a bounding box hit, 64 pixels
+//	   at a time with shifted ANDs.
+//-----------------------------------------------------------------------------
+
+#ifndef _CCOLLISIONMASK_H_
+#define _CCOLLISIONMASK_H_
+
+//-----------------------------------------------------------------------------
+// CCollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CCollisionMask (Class)
+// Desc : Rows of 64 bit words, pixel x of a row is bit (x & 63) of word
+//		(x >> 6). Every row carries one extra zero word so a shifted read
+//		never needs a bounds check.
+//-----------------------------------------------------------------------------
+class CCollisionMask
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CCollisionMask();
+	virtual ~CCollisionMask();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Solid where alpha is non zero, e.g. atlas pixels or a colour keyed decode
+	void					BuildFromAlpha( const uint32_t* pPixels, size_t nPitch, int nWidth, int nHeight );
+	// Solid where the RGB is black, the convention of our SRCAND masks
+	void					BuildFromMask( const uint32_t* pPixels, size_t nPitch, int nWidth, int nHeight );
+	void					Release( );
+
+	bool					IsEmpty( ) const { return m_Bits.empty(); }
+	int						GetWidth( ) const { return m_nWidth; }
+	int						GetHeight( ) const { return m_nHeight; }
+	bool					IsSolid( int x, int y ) const;
+
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class.
+	//-------------------------------------------------------------------------
+	// (ax, ay) and (bx, by) are the masks' top left corners in world pixels
+	static bool				Overlap( const CCollisionMask& A, int ax, int ay, const CCollisionMask& B, int bx, int by );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Resize( int nWidth, int nHeight );
+	uint64_t				ReadBits( int y, int x ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_nWidth;
+	int						m_nHeight;
+	int						m_nWords;			// Per row, including the padding word
+	std::vector<uint64_t>	m_Bits;
+};
+
+#endif // _CCOLLISIONMASK_H_
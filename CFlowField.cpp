@@ -0,0 +1,219 @@
+//-----------------------------------------------------------------------------
+// File: CFlowField.cpp
+//
+// Desc: Grid flow field covering the playfield. Every cell stores the
+//	   direction towards the nearest player, so any number of enemies can
+//	   steer with a single lookup instead of running their own pathfinding.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFlowField Specific Includes
+//-----------------------------------------------------------------------------
+#include "CFlowField.h"
+#include "CTelemetry.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const UCHAR		DIR_NONE	= 8;
+	const USHORT	DIST_NONE	= 0xFFFF;
+	const float		DIAG		= 0.70710678f;
+
+	// Neighbour offsets and the unit vector used for steering along each one
+	const int		DirX[9]		= { -1,  0,  1, -1, 1, -1, 0, 1, 0 };
+	const int		DirY[9]		= { -1, -1, -1,  0, 0,  1, 1, 1, 0 };
+	const float		DirVecX[9]	= { -DIAG, 0.0f, DIAG, -1.0f, 1.0f, -DIAG, 0.0f, DIAG, 0.0f };
+	const float		DirVecY[9]	= { -DIAG, -1.0f, -DIAG, 0.0f, 0.0f, DIAG, 1.0f, DIAG, 0.0f };
+}
+
+//-----------------------------------------------------------------------------
+// Name : CFlowField () (Constructor)
+// Desc : CFlowField Class Constructor
+//-----------------------------------------------------------------------------
+CFlowField::CFlowField() : m_nFront(-1), m_bBuilding(false)
+{
+	m_pPool		= NULL;
+	m_nCols		= 0;
+	m_nRows		= 0;
+	m_nCellSize	= 1;
+	m_nTargets	= 0;
+	m_bDirty	= false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFlowField () (Destructor)
+// Desc : CFlowField Class Destructor
+//-----------------------------------------------------------------------------
+CFlowField::~CFlowField()
+{
+	// An in flight rebuild writes into our buffers, let it finish first
+	while ( m_bBuilding.load() ) std::this_thread::yield();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init ()
+// Desc : Sizes the grid to cover a nWidth x nHeight playfield.
+//-----------------------------------------------------------------------------
+void CFlowField::Init( CThreadPool* pPool, int nWidth, int nHeight, int nCellSize )
+{
+	while ( m_bBuilding.load() ) std::this_thread::yield();
+
+	m_pPool		= pPool;
+	m_nCellSize	= ( nCellSize > 0 ) ? nCellSize : 1;
+	m_nCols		= ( nWidth  + m_nCellSize - 1 ) / m_nCellSize;
+	m_nRows		= ( nHeight + m_nCellSize - 1 ) / m_nCellSize;
+	if ( m_nCols < 1 ) m_nCols = 1;
+	if ( m_nRows < 1 ) m_nRows = 1;
+
+	for ( int i = 0; i < 2; ++i )
+	{
+		m_Fields[i].Direction.assign( m_nCols * m_nRows, DIR_NONE );
+		m_Fields[i].Distance.assign( m_nCols * m_nRows, DIST_NONE );
+	}
+
+	m_nFront	= -1;
+	m_nTargets	= 0;
+	m_bDirty	= false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetTargets ()
+// Desc : Updates the positions the field flows towards. A rebuild is only
+//		queued when a target crossed a cell boundary, and only one rebuild is
+//		in flight at a time; later changes are picked up once it completes.
+//-----------------------------------------------------------------------------
+void CFlowField::SetTargets( const Vec2* pTargets, int nCount )
+{
+	if ( m_nCols * m_nRows == 0 ) return;
+	if ( nCount > MAX_TARGETS ) nCount = MAX_TARGETS;
+
+	if ( nCount != m_nTargets ) m_bDirty = true;
+	for ( int i = 0; i < nCount; ++i )
+	{
+		int nCell = CellOf( pTargets[i] );
+		if ( i >= m_nTargets || m_TargetCells[i] != nCell ) m_bDirty = true;
+		m_TargetCells[i] = nCell;
+	}
+	m_nTargets = nCount;
+
+	if ( !m_bDirty || m_bBuilding.load() ) return;
+
+	// Build into whichever field readers are not using
+	int nBack = ( m_nFront.load() == 0 ) ? 1 : 0;
+	int TargetCells[MAX_TARGETS];
+	for ( int i = 0; i < nCount; ++i ) TargetCells[i] = m_TargetCells[i];
+
+	m_bDirty	= false;
+	m_bBuilding	= true;
+
+	auto Job = [this, nBack, TargetCells, nCount]()
+	{
+		CTelemetry::Scope Tag( CTelemetry::SUB_AI );
+		Rebuild( m_Fields[nBack], TargetCells, nCount );
+		m_nFront.store( nBack, std::memory_order_release );
+		m_bBuilding.store( false, std::memory_order_release );
+	};
+
+	if ( m_pPool ) m_pPool->Submit( Job ); else Job();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Steer ()
+// Desc : Returns the unit direction to follow from Position, or a zero
+//		vector when standing on a target or before the first build.
+//-----------------------------------------------------------------------------
+Vec2 CFlowField::Steer( const Vec2& Position ) const
+{
+	int nFront = m_nFront.load( std::memory_order_acquire );
+	if ( nFront < 0 ) return Vec2( 0, 0 );
+
+	UCHAR Dir = m_Fields[nFront].Direction[ CellOf( Position ) ];
+	return Vec2( DirVecX[Dir], DirVecY[Dir] );
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsReady ()
+// Desc : True once at least one field has been built.
+//-----------------------------------------------------------------------------
+bool CFlowField::IsReady() const
+{
+	return m_nFront.load( std::memory_order_acquire ) >= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CellOf () (Private)
+// Desc : Maps a playfield position to a cell index, clamped to the grid.
+//-----------------------------------------------------------------------------
+int CFlowField::CellOf( const Vec2& Position ) const
+{
+	int nCol = (int)( Position.x / m_nCellSize );
+	int nRow = (int)( Position.y / m_nCellSize );
+
+	if ( nCol < 0 ) nCol = 0; else if ( nCol >= m_nCols ) nCol = m_nCols - 1;
+	if ( nRow < 0 ) nRow = 0; else if ( nRow >= m_nRows ) nRow = m_nRows - 1;
+
+	return nRow * m_nCols + nCol;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Rebuild () (Private)
+// Desc : Multi source BFS from the target cells, then points every cell at
+//		its closest neighbour. Runs on a pool worker.
+//-----------------------------------------------------------------------------
+void CFlowField::Rebuild( Field& Out, const int* pTargetCells, int nCount ) const
+{
+	const int nCells = m_nCols * m_nRows;
+	std::vector<int> Queue;
+	Queue.reserve( nCells );
+
+	std::fill( Out.Distance.begin(), Out.Distance.end(), DIST_NONE );
+	for ( int i = 0; i < nCount; ++i )
+	{
+		if ( Out.Distance[ pTargetCells[i] ] == 0 ) continue;
+		Out.Distance[ pTargetCells[i] ] = 0;
+		Queue.push_back( pTargetCells[i] );
+	}
+
+	// Breadth first flood, 8-connected so distances are in Chebyshev cells
+	for ( size_t nHead = 0; nHead < Queue.size(); ++nHead )
+	{
+		int nCell = Queue[nHead];
+		int nCol  = nCell % m_nCols;
+		int nRow  = nCell / m_nCols;
+		USHORT nNext = Out.Distance[nCell] + 1;
+
+		for ( int d = 0; d < 8; ++d )
+		{
+			int nc = nCol + DirX[d], nr = nRow + DirY[d];
+			if ( nc < 0 || nr < 0 || nc >= m_nCols || nr >= m_nRows ) continue;
+
+			int nIndex = nr * m_nCols + nc;
+			if ( Out.Distance[nIndex] != DIST_NONE ) continue;
+			Out.Distance[nIndex] = nNext;
+			Queue.push_back( nIndex );
+		}
+	}
+
+	// Point each cell at the neighbour closest to a target
+	for ( int nCell = 0; nCell < nCells; ++nCell )
+	{
+		int nCol = nCell % m_nCols;
+		int nRow = nCell / m_nCols;
+		USHORT nBest = Out.Distance[nCell];
+		UCHAR  Dir   = DIR_NONE;
+
+		for ( int d = 0; d < 8; ++d )
+		{
+			int nc = nCol + DirX[d], nr = nRow + DirY[d];
+			if ( nc < 0 || nr < 0 || nc >= m_nCols || nr >= m_nRows ) continue;
+
+			USHORT nDist = Out.Distance[ nr * m_nCols + nc ];
+			if ( nDist < nBest ) { nBest = nDist; Dir = (UCHAR)d; }
+		}
+
+		Out.Direction[nCell] = Dir;
+	}
+}
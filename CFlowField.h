@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// File: CFlowField.h
+//
+// Desc: Grid flow field covering the playfield. Every cell stores the
+//	   direction towards the nearest player, so any number of enemies can
+//	   steer with a single lookup instead of running their own pathfinding.
+//-----------------------------------------------------------------------------
+
+#ifndef _CFLOWFIELD_H_
+#define _CFLOWFIELD_H_
+
+//-----------------------------------------------------------------------------
+// CFlowField Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CThreadPool.h"
+#include <vector>
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFlowField (Class)
+// Desc : Double buffered direction grid. Rebuilds run as a background job on
+//		the thread pool and only when a target moves into a different cell.
+// Note : SetTargets and Steer must be called from the same (game) thread.
+//-----------------------------------------------------------------------------
+class CFlowField
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum { MAX_TARGETS = 4 };
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFlowField();
+	virtual ~CFlowField();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Init( CThreadPool* pPool, int nWidth, int nHeight, int nCellSize );
+	void					SetTargets( const Vec2* pTargets, int nCount );
+	Vec2					Steer( const Vec2& Position ) const;
+	bool					IsReady( ) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class.
+	//-------------------------------------------------------------------------
+	struct Field
+	{
+		std::vector<UCHAR>	Direction;		// Index into the direction table, DIR_NONE at a target
+		std::vector<USHORT>	Distance;		// BFS scratch, cells to the nearest target
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	int						CellOf( const Vec2& Position ) const;
+	void					Rebuild( Field& Out, const int* pTargetCells, int nCount ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	CThreadPool*			m_pPool;
+	int						m_nCols;
+	int						m_nRows;
+	int						m_nCellSize;
+
+	Field					m_Fields[2];
+	std::atomic<int>		m_nFront;			// Field readers use, -1 until the first build
+	std::atomic<bool>		m_bBuilding;		// A rebuild job is in flight
+
+	int						m_TargetCells[MAX_TARGETS];
+	int						m_nTargets;
+	bool					m_bDirty;			// Targets changed since the last build started
+};
+
+#endif // _CFLOWFIELD_H_
@@ -0,0 +1,205 @@
+//-----------------------------------------------------------------------------
+// File: CFrameArena.cpp
+//
+// Desc: Bump allocator for scratch memory that only lives for one frame
+//	   (collision work, pair lists, event queues). Allocation is a pointer
+//	   bump, everything is dropped at once by Reset at the end of the frame.
+//	   Debug builds also count the frame's calls to the global heap.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFrameArena Specific Includes
+//-----------------------------------------------------------------------------
+#include "CFrameArena.h"
+#include <cstring>
+#include <cstdio>
+
+#if defined(_DEBUG) && defined(_MSC_VER)
+	#define FRAMEARENA_HEAP_HOOK
+	#include <crtdbg.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Helpers
+//-----------------------------------------------------------------------------
+namespace
+{
+	const size_t	MAX_ALIGN		= 64;
+	const size_t	MAX_OVERFLOWS	= 64;	// Overflow list capacity reserved up front
+
+#ifdef FRAMEARENA_HEAP_HOOK
+	// CRT allocations made by the thread that owns the arena
+	DWORD				g_dwHeapThread	= 0;
+	volatile ULONG		g_nHeapAllocs	= 0;
+	_CRT_ALLOC_HOOK		g_pPrevHook		= NULL;
+
+	int __cdecl CountHeapAllocs( int nAllocType, void* pvData, size_t nSize, int nBlockUse, long lRequest, const unsigned char* szFile, int nLine )
+	{
+		if ( ( nAllocType == _HOOK_ALLOC || nAllocType == _HOOK_REALLOC ) && GetCurrentThreadId() == g_dwHeapThread )
+			++g_nHeapAllocs;
+
+		if ( g_pPrevHook ) return g_pPrevHook( nAllocType, pvData, nSize, nBlockUse, lRequest, szFile, nLine );
+		return TRUE;
+	}
+#endif
+
+	inline ULONG HeapAllocCount()
+	{
+#ifdef FRAMEARENA_HEAP_HOOK
+		return g_nHeapAllocs;
+#else
+		return 0;
+#endif
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CFrameArena () (Constructor)
+// Desc : CFrameArena Class Constructor
+//-----------------------------------------------------------------------------
+CFrameArena::CFrameArena()
+{
+	m_pBlock			= NULL;
+	m_nCapacity			= 0;
+	m_nUsed				= 0;
+	m_nOverflowBytes	= 0;
+	m_nAllocs			= 0;
+	m_nHeapMark			= 0;
+	memset( &m_Stats, 0, sizeof(m_Stats) );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFrameArena () (Destructor)
+// Desc : CFrameArena Class Destructor
+//-----------------------------------------------------------------------------
+CFrameArena::~CFrameArena()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init ()
+// Desc : Allocates the block. The calling thread becomes the owner, the one
+//		whose heap calls debug builds count.
+//-----------------------------------------------------------------------------
+bool CFrameArena::Init( size_t nCapacity )
+{
+	Release();
+
+	m_pBlock = (BYTE*)_aligned_malloc( nCapacity, MAX_ALIGN );
+	if ( !m_pBlock ) return false;
+
+	m_nCapacity = nCapacity;
+	m_Overflow.reserve( MAX_OVERFLOWS );
+	memset( &m_Stats, 0, sizeof(m_Stats) );
+	m_Stats.nCapacity = nCapacity;
+
+#ifdef FRAMEARENA_HEAP_HOOK
+	g_dwHeapThread	= GetCurrentThreadId();
+	g_pPrevHook		= _CrtSetAllocHook( CountHeapAllocs );
+#endif
+	m_nHeapMark = HeapAllocCount();
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the block and anything that overflowed it.
+//-----------------------------------------------------------------------------
+void CFrameArena::Release()
+{
+	if ( !m_pBlock ) return;
+
+#ifdef FRAMEARENA_HEAP_HOOK
+	_CrtSetAllocHook( g_pPrevHook );
+	g_pPrevHook = NULL;
+#endif
+
+	for ( void* p : m_Overflow ) _aligned_free( p );
+	m_Overflow.clear();
+	_aligned_free( m_pBlock );
+
+	m_pBlock			= NULL;
+	m_nCapacity			= 0;
+	m_nUsed				= 0;
+	m_nOverflowBytes	= 0;
+	m_nAllocs			= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Alloc ()
+// Desc : Returns nBytes aligned to nAlign (a power of two up to 64), valid
+//		until the next Reset.
+//-----------------------------------------------------------------------------
+void* CFrameArena::Alloc( size_t nBytes, size_t nAlign )
+{
+	++m_nAllocs;
+
+	size_t nOffset = ( m_nUsed + nAlign - 1 ) & ~( nAlign - 1 );
+	if ( m_pBlock && nOffset + nBytes <= m_nCapacity )
+	{
+		m_nUsed = nOffset + nBytes;
+		return m_pBlock + nOffset;
+	}
+
+	// Out of room, serve this frame from the heap and grow on Reset
+	void* p = _aligned_malloc( nBytes ? nBytes : 1, MAX_ALIGN );
+	if ( !p ) return NULL;
+
+	m_Overflow.push_back( p );
+	m_nOverflowBytes += nBytes + MAX_ALIGN;
+	return p;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Ends the frame. Everything allocated since the last Reset is
+//		invalid afterwards.
+//-----------------------------------------------------------------------------
+void CFrameArena::Reset()
+{
+	size_t nFrameBytes = m_nUsed + m_nOverflowBytes;
+	ULONG  nHeapCount  = HeapAllocCount();
+
+	m_Stats.nBytes		= nFrameBytes;
+	m_Stats.nAllocs		= m_nAllocs;
+	m_Stats.nOverflows	= (ULONG)m_Overflow.size();
+	m_Stats.nHeapAllocs	= nHeapCount - m_nHeapMark;
+	if ( nFrameBytes > m_Stats.nPeakBytes ) m_Stats.nPeakBytes = nFrameBytes;
+	m_Stats.nFrames++;
+
+	if ( !m_Overflow.empty() )
+	{
+		for ( void* p : m_Overflow ) _aligned_free( p );
+		m_Overflow.clear();
+
+		// Make next frame fit with some slack
+		size_t nCapacity = nFrameBytes + nFrameBytes / 2;
+		BYTE*  pBlock	 = (BYTE*)_aligned_malloc( nCapacity, MAX_ALIGN );
+		if ( pBlock )
+		{
+			_aligned_free( m_pBlock );
+			m_pBlock			= pBlock;
+			m_nCapacity			= nCapacity;
+			m_Stats.nCapacity	= nCapacity;
+		}
+	}
+
+#ifdef _DEBUG
+	// Stale pointers into last frame's scratch show up as garbage quickly
+	if ( m_pBlock ) memset( m_pBlock, 0xCD, m_nUsed );
+
+	if ( m_Stats.nHeapAllocs )
+	{
+		char szMessage[128];
+		sprintf_s( szMessage, "Frame %lu: %lu global heap allocation(s) on the game thread\n", m_Stats.nFrames, m_Stats.nHeapAllocs );
+		OutputDebugStringA( szMessage );
+	}
+#endif
+
+	m_nUsed				= 0;
+	m_nOverflowBytes	= 0;
+	m_nAllocs			= 0;
+	m_nHeapMark			= HeapAllocCount();
+}
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// File: CFrameArena.h
+//
+// Desc: Bump allocator for scratch memory that only lives for one frame
+//	   (collision work, pair lists, event queues). Allocation is a pointer
+//	   bump, everything is dropped at once by Reset at the end of the frame.
+//	   Debug builds also count the frame's calls to the global heap.
+//-----------------------------------------------------------------------------
+
+#ifndef _CFRAMEARENA_H_
+#define _CFRAMEARENA_H_
+
+//-----------------------------------------------------------------------------
+// CFrameArena Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFrameArena (Class)
+// Desc : One block, owned by the game thread. A request that does not fit is
+//		served from the heap and counted as an overflow; the next Reset
+//		grows the block to the frame's total so the game settles at zero
+//		heap calls. Memory is not constructed or destroyed, use it for
+//		trivially destructible types only.
+//-----------------------------------------------------------------------------
+class CFrameArena
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Stats
+	{
+		size_t			nCapacity;			// Size of the block
+		size_t			nBytes;				// Used by the last finished frame
+		size_t			nPeakBytes;			// Most any frame used
+		ULONG			nAllocs;			// Arena allocations last frame
+		ULONG			nOverflows;			// Of those, how many went to the heap
+		ULONG			nHeapAllocs;		// Global heap calls on this thread last frame, debug builds only
+		ULONG			nFrames;
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFrameArena();
+	virtual ~CFrameArena();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Init( size_t nCapacity );
+	void					Release( );
+
+	void*					Alloc( size_t nBytes, size_t nAlign = 16 );
+	void					Reset( );
+	void					GetStats( Stats& Out ) const { Out = m_Stats; }
+
+	template <typename T>
+	T*						AllocArray( size_t nCount ) { return static_cast<T*>( Alloc( sizeof(T) * nCount, alignof(T) ) ); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	BYTE*					m_pBlock;
+	size_t					m_nCapacity;
+	size_t					m_nUsed;
+	size_t					m_nOverflowBytes;
+	ULONG					m_nAllocs;
+	std::vector<void*>		m_Overflow;			// Heap blocks handed out this frame
+	Stats					m_Stats;
+	ULONG					m_nHeapMark;		// Heap counter at the last Reset
+};
+
+#endif // _CFRAMEARENA_H_
@@ -0,0 +1,285 @@
+//-----------------------------------------------------------------------------
+// File: CFrameCapture.cpp
+//
+// Desc: Records presented frames to disk without stalling the presenter.
+//	   After present() the back buffer is blitted into the next free slot
+//	   of a preallocated ring of DIB sections; a writer thread converts and
+//	   appends slots to a Y4M (or raw BGRA) file. When the writer falls
+//	   behind and the ring is full the frame is dropped and counted.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFrameCapture Specific Includes
+//-----------------------------------------------------------------------------
+#include "CFrameCapture.h"
+#include "CTelemetry.h"
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+namespace
+{
+	inline BYTE Clamp255( int n ) { return (BYTE)( n < 0 ? 0 : ( n > 255 ? 255 : n ) ); }
+}
+
+//-----------------------------------------------------------------------------
+// Name : CFrameCapture () (Constructor)
+// Desc : CFrameCapture Class Constructor
+//-----------------------------------------------------------------------------
+CFrameCapture::CFrameCapture()
+{
+	m_bRunning		= false;
+	m_Format		= FORMAT_Y4M;
+	m_nWidth		= 0;
+	m_nHeight		= 0;
+	m_nEvery		= 1;
+	m_pFile			= NULL;
+	m_hDC			= NULL;
+	m_hOldBitmap	= NULL;
+	m_nHead			= 0;
+	m_nTail			= 0;
+	m_nDropped		= 0;
+	m_bQuit			= false;
+	m_hWake			= NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFrameCapture () (Destructor)
+// Desc : CFrameCapture Class Destructor
+//-----------------------------------------------------------------------------
+CFrameCapture::~CFrameCapture()
+{
+	Stop();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+// Desc : Opens szPath (".y4m" gives Y4M, anything else raw BGRA) and
+//		allocates nSlots frames of nWidth x nHeight, rounded down to even.
+//		Only frames whose number is a multiple of nEvery are kept. Nothing
+//		here touches the back buffer, so any thread may call it.
+//-----------------------------------------------------------------------------
+bool CFrameCapture::Start( int nWidth, int nHeight, const char* szPath, int nEvery, int nFPS, int nSlots )
+{
+	std::lock_guard<std::mutex> Lock( m_Lock );
+	if ( m_bRunning || nWidth < 2 || nHeight < 2 || nSlots < 2 ) return false;
+
+	const char* szExt = strrchr( szPath, '.' );
+	m_Format	= ( szExt && _stricmp( szExt, ".y4m" ) == 0 ) ? FORMAT_Y4M : FORMAT_RAW;
+	m_nWidth	= nWidth & ~1;
+	m_nHeight	= nHeight & ~1;
+	m_nEvery	= nEvery > 0 ? nEvery : 1;
+
+	BITMAPINFO bmi;
+	memset( &bmi, 0, sizeof(bmi) );
+	bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		= m_nWidth;
+	bmi.bmiHeader.biHeight		= -m_nHeight;		// Top down
+	bmi.bmiHeader.biPlanes		= 1;
+	bmi.bmiHeader.biBitCount	= 32;
+	bmi.bmiHeader.biCompression	= BI_RGB;
+
+	m_Slots.resize( nSlots );
+	for ( Slot& s : m_Slots )
+	{
+		void* pBits = NULL;
+		s.hBitmap	= CreateDIBSection( NULL, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0 );
+		s.pPixels	= (ULONG*)pBits;
+		s.nFrame	= 0;
+		if ( s.hBitmap ) CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, 1 );
+		else { ReleaseSlots(); return false; }
+	}
+
+	m_hDC = CreateCompatibleDC( NULL );
+	if ( !m_hDC ) { ReleaseSlots(); return false; }
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, 1 );
+	m_hOldBitmap = SelectObject( m_hDC, m_Slots[0].hBitmap );
+
+	if ( fopen_s( &m_pFile, szPath, "wb" ) != 0 ) { m_pFile = NULL; ReleaseSlots(); return false; }
+	if ( m_Format == FORMAT_Y4M )
+	{
+		fprintf( m_pFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", m_nWidth, m_nHeight, nFPS > 0 ? nFPS : 60 );
+		m_Planes.resize( m_nWidth * m_nHeight * 3 / 2 );
+	}
+
+	// Without the event the writer would wait on nothing, so no capture
+	m_hWake = CreateEvent( NULL, FALSE, FALSE, NULL );
+	if ( !m_hWake )
+	{
+		fclose( m_pFile );
+		m_pFile = NULL;
+		ReleaseSlots();
+		return false;
+	}
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, 1 );
+
+	m_nHead		= 0;
+	m_nTail		= 0;
+	m_nDropped	= 0;
+	m_bQuit		= false;
+	m_Writer	= std::thread( &CFrameCapture::WriterProc, this );
+	m_bRunning	= true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Stop ()
+// Desc : Lets the writer drain the ring, closes the file and reports the
+//		counts to the debugger.
+//-----------------------------------------------------------------------------
+void CFrameCapture::Stop()
+{
+	std::lock_guard<std::mutex> Lock( m_Lock );
+	if ( !m_bRunning ) return;
+	m_bRunning = false;
+
+	m_bQuit = true;
+	SetEvent( m_hWake );
+	m_Writer.join();
+
+	CloseHandle( m_hWake );
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, -1 );
+	m_hWake = NULL;
+
+	fclose( m_pFile );
+	m_pFile = NULL;
+	ReleaseSlots();
+
+	char szLine[128];
+	sprintf_s( szLine, "Capture: %lu frames written, %lu dropped\n", m_nTail.load(), m_nDropped.load() );
+	OutputDebugStringA( szLine );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Capture ()
+// Desc : Call right after present(). Copies the frame into the ring, or
+//		counts a drop when every slot is still waiting for the writer.
+//-----------------------------------------------------------------------------
+void CFrameCapture::Capture( HDC hdcSource, ULONG nFrame )
+{
+	std::lock_guard<std::mutex> Lock( m_Lock );
+	if ( !m_bRunning || nFrame % m_nEvery ) return;
+
+	ULONG nHead = m_nHead.load( std::memory_order_relaxed );
+	if ( nHead - m_nTail.load( std::memory_order_acquire ) >= m_Slots.size() )
+	{
+		m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+		return;
+	}
+
+	Slot& s = m_Slots[nHead % m_Slots.size()];
+	SelectObject( m_hDC, s.hBitmap );
+	BitBlt( m_hDC, 0, 0, m_nWidth, m_nHeight, hdcSource, 0, 0, SRCCOPY );
+	GdiFlush();		// The writer reads the bits directly
+	s.nFrame = nFrame;
+
+	m_nHead.store( nHead + 1, std::memory_order_release );
+	SetEvent( m_hWake );
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStats ()
+// Desc : Counts since Start, safe from any thread.
+//-----------------------------------------------------------------------------
+CFrameCapture::Stats CFrameCapture::GetStats() const
+{
+	Stats Out;
+	Out.nCaptured	= m_nHead.load( std::memory_order_relaxed );
+	Out.nWritten	= m_nTail.load( std::memory_order_relaxed );
+	Out.nDropped	= m_nDropped.load( std::memory_order_relaxed );
+	return Out;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriterProc () (Private)
+// Desc : Writer thread body. Writes slots in order until told to quit, then
+//		finishes whatever is left in the ring.
+//-----------------------------------------------------------------------------
+void CFrameCapture::WriterProc()
+{
+	CTelemetry::Scope Tag( CTelemetry::SUB_GRAPHICS );
+
+	for ( ;; )
+	{
+		WaitForSingleObject( m_hWake, 100 );
+		bool bQuit = m_bQuit;
+
+		ULONG nTail = m_nTail.load( std::memory_order_relaxed );
+		while ( nTail != m_nHead.load( std::memory_order_acquire ) )
+		{
+			WriteSlot( m_Slots[nTail % m_Slots.size()] );
+			m_nTail.store( ++nTail, std::memory_order_release );
+		}
+
+		if ( bQuit ) break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteSlot () (Private)
+// Desc : Appends one frame. Y4M gets BT.601 full range 4:2:0, chroma from
+//		the average of each 2x2 block.
+//-----------------------------------------------------------------------------
+bool CFrameCapture::WriteSlot( const Slot& In )
+{
+	size_t nPixels = (size_t)m_nWidth * m_nHeight;
+	if ( m_Format == FORMAT_RAW )
+		return fwrite( In.pPixels, sizeof(ULONG), nPixels, m_pFile ) == nPixels;
+
+	BYTE* pY = &m_Planes[0];
+	BYTE* pU = pY + nPixels;
+	BYTE* pV = pU + nPixels / 4;
+
+	for ( int y = 0; y < m_nHeight; y += 2 )
+	{
+		const ULONG* pRow0 = In.pPixels + (size_t)y * m_nWidth;
+		const ULONG* pRow1 = pRow0 + m_nWidth;
+		BYTE*		 pY0   = pY + (size_t)y * m_nWidth;
+		BYTE*		 pY1   = pY0 + m_nWidth;
+
+		for ( int x = 0; x < m_nWidth; x += 2 )
+		{
+			int nR = 0, nG = 0, nB = 0;
+			const ULONG Quad[4] = { pRow0[x], pRow0[x + 1], pRow1[x], pRow1[x + 1] };
+			BYTE* const pOut[4] = { pY0 + x, pY0 + x + 1, pY1 + x, pY1 + x + 1 };
+
+			for ( int i = 0; i < 4; ++i )
+			{
+				int r = ( Quad[i] >> 16 ) & 0xFF, g = ( Quad[i] >> 8 ) & 0xFF, b = Quad[i] & 0xFF;
+				*pOut[i] = (BYTE)( ( 77 * r + 150 * g + 29 * b + 128 ) >> 8 );
+				nR += r; nG += g; nB += b;
+			}
+
+			*pU++ = Clamp255( ( ( -43 * nR - 85 * nG + 128 * nB + 512 ) >> 10 ) + 128 );
+			*pV++ = Clamp255( ( ( 128 * nR - 107 * nG - 21 * nB + 512 ) >> 10 ) + 128 );
+		}
+	}
+
+	fputs( "FRAME\n", m_pFile );
+	return fwrite( &m_Planes[0], 1, m_Planes.size(), m_pFile ) == m_Planes.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseSlots () (Private)
+// Desc : Frees the capture DC and every slot bitmap.
+//-----------------------------------------------------------------------------
+void CFrameCapture::ReleaseSlots()
+{
+	if ( m_hDC )
+	{
+		SelectObject( m_hDC, m_hOldBitmap );
+		DeleteDC( m_hDC );
+		CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, -1 );
+		m_hDC = NULL;
+	}
+
+	for ( Slot& s : m_Slots )
+	{
+		if ( !s.hBitmap ) continue;
+		DeleteObject( s.hBitmap );
+		CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, -1 );
+	}
+	m_Slots.clear();
+	m_Planes.clear();
+}
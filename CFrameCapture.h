@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// File: CFrameCapture.h
+//
+// Desc: Records presented frames to disk without stalling the presenter.
+//	   After present() the back buffer is blitted into the next free slot
+//	   of a preallocated ring of DIB sections; a writer thread converts and
+//	   appends slots to a Y4M (or raw BGRA) file. When the writer falls
+//	   behind and the ring is full the frame is dropped and counted.
+//-----------------------------------------------------------------------------
+
+#ifndef _CFRAMECAPTURE_H_
+#define _CFRAMECAPTURE_H_
+
+//-----------------------------------------------------------------------------
+// CFrameCapture Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFrameCapture (Class)
+// Desc : Single producer (whichever thread presents), single consumer (the
+//		writer thread). Start / Stop may come from another thread, a lock
+//		keeps them away from Capture.
+//-----------------------------------------------------------------------------
+class CFrameCapture
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum FORMAT
+	{
+		FORMAT_Y4M,				// 4:2:0 full range, plays in ffplay / mpv
+		FORMAT_RAW				// Top down BGRA, lossless for golden image diffs
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Stats
+	{
+		ULONG		nCaptured;		// Copied into the ring
+		ULONG		nWritten;		// Reached the file
+		ULONG		nDropped;		// Ring was full
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFrameCapture();
+	virtual ~CFrameCapture();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool				Start( int nWidth, int nHeight, const char* szPath, int nEvery = 1, int nFPS = 60, int nSlots = 8 );
+	void				Stop( );
+	bool				IsRunning( ) const { return m_bRunning; }
+	void				Capture( HDC hdcSource, ULONG nFrame );
+	Stats				GetStats( ) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Slot
+	{
+		HBITMAP		hBitmap;
+		ULONG*		pPixels;		// Top down BGRA, owned by hBitmap
+		ULONG		nFrame;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void				WriterProc( );
+	bool				WriteSlot( const Slot& In );
+	void				ReleaseSlots( );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	mutable std::mutex		m_Lock;				// Start / Stop against Capture
+	bool					m_bRunning;
+	FORMAT					m_Format;
+	int						m_nWidth;			// Even, 4:2:0 needs it
+	int						m_nHeight;
+	int						m_nEvery;			// Capture every Nth frame
+	FILE*					m_pFile;
+	HDC						m_hDC;				// Slots are selected in turn to blit into
+	HGDIOBJ					m_hOldBitmap;
+	std::vector<Slot>		m_Slots;
+	std::vector<BYTE>		m_Planes;			// Writer's conversion buffer
+	std::atomic<ULONG>		m_nHead;			// Slots filled, producer side
+	std::atomic<ULONG>		m_nTail;			// Slots written, writer side
+	std::atomic<ULONG>		m_nDropped;
+	std::atomic<bool>		m_bQuit;
+	HANDLE					m_hWake;			// Auto reset, set per captured frame
+	std::thread				m_Writer;
+};
+
+#endif // _CFRAMECAPTURE_H_
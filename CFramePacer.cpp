@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// File: CFramePacer.cpp
+//
+// Desc: Frame pacing for the main loop. Paces frames to a target rate with a
+//	   hybrid sleep-then-spin wait, sleeps while the app is inactive instead
+//	   of spinning, and keeps frame time jitter statistics.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFramePacer Specific Includes
+//-----------------------------------------------------------------------------
+#include "CFramePacer.h"
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// Name : CFramePacer () (Constructor)
+// Desc : CFramePacer Class Constructor
+//-----------------------------------------------------------------------------
+CFramePacer::CFramePacer()
+{
+	LARGE_INTEGER Frequency;
+	QueryPerformanceFrequency( &Frequency );
+	m_nFrequency	= Frequency.QuadPart;
+
+	m_fTargetFPS	= 0;
+	m_nPeriod		= 0;
+	m_nDeadline		= 0;
+	m_nLastFrame	= 0;
+	m_nSamples		= 0;
+	m_nMissed		= 0;
+
+	// 1ms scheduler granularity so the sleep part of a wait is usable
+	timeBeginPeriod( 1 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFramePacer () (Destructor)
+// Desc : CFramePacer Class Destructor
+//-----------------------------------------------------------------------------
+CFramePacer::~CFramePacer()
+{
+	timeEndPeriod( 1 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetTargetFPS ()
+// Desc : Sets the paced frame rate, 0 disables pacing.
+//-----------------------------------------------------------------------------
+void CFramePacer::SetTargetFPS( double fFPS )
+{
+	m_fTargetFPS	= ( fFPS > 0 ) ? fFPS : 0;
+	m_nPeriod		= ( fFPS > 0 ) ? (LONGLONG)( m_nFrequency / fFPS ) : 0;
+	m_nDeadline		= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitForFrame ()
+// Desc : Waits until the next frame is due. Returns true when a frame should
+//		run, false when a window message arrived first and must be pumped.
+//		While inactive it blocks on messages, ticking only every
+//		IDLE_TIMEOUT_MS so the game timer keeps sane deltas.
+//-----------------------------------------------------------------------------
+bool CFramePacer::WaitForFrame( bool bActive )
+{
+	if ( !bActive )
+	{
+		m_nLastFrame	= 0;
+		m_nDeadline		= 0;
+		return MsgWaitForMultipleObjects( 0, NULL, FALSE, IDLE_TIMEOUT_MS, QS_ALLINPUT ) != WAIT_OBJECT_0;
+	}
+
+	LONGLONG nNow = Now();
+
+	if ( m_nPeriod > 0 && m_nDeadline != 0 && nNow < m_nDeadline )
+	{
+		// Sleep for the bulk of the wait, waking early for any message
+		LONGLONG nSpin = m_nFrequency * SPIN_US / 1000000;
+		LONGLONG nLeft = m_nDeadline - nNow;
+		if ( nLeft > nSpin )
+		{
+			DWORD nSleepMs = (DWORD)( ( nLeft - nSpin ) * 1000 / m_nFrequency );
+			if ( nSleepMs > 0 && MsgWaitForMultipleObjects( 0, NULL, FALSE, nSleepMs, QS_ALLINPUT ) == WAIT_OBJECT_0 )
+				return false;
+		}
+
+		// Spin the rest for a precise deadline
+		while ( ( nNow = Now() ) < m_nDeadline ) std::this_thread::yield();
+	}
+
+	if ( m_nPeriod > 0 )
+	{
+		// Advance on the fixed grid, resync if we fell more than a frame behind
+		m_nDeadline = ( m_nDeadline == 0 ) ? nNow + m_nPeriod : m_nDeadline + m_nPeriod;
+		if ( m_nDeadline < nNow )
+		{
+			m_nDeadline = nNow + m_nPeriod;
+			m_nMissed++;
+		}
+	}
+
+	RecordFrame( nNow );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStats ()
+// Desc : Summarises the recent frame intervals.
+//-----------------------------------------------------------------------------
+void CFramePacer::GetStats( Stats& Out ) const
+{
+	memset( &Out, 0, sizeof(Out) );
+	Out.nMissed = m_nMissed;
+
+	ULONG nCount = std::min<ULONG>( m_nSamples, HISTORY );
+	if ( nCount == 0 ) return;
+
+	float Sorted[HISTORY];
+	double fSum = 0, fSumSq = 0;
+	for ( ULONG i = 0; i < nCount; ++i )
+	{
+		Sorted[i] = m_History[i];
+		fSum   += m_History[i];
+		fSumSq += (double)m_History[i] * m_History[i];
+	}
+	std::sort( Sorted, Sorted + nCount );
+
+	double fVariance = fSumSq / nCount - ( fSum / nCount ) * ( fSum / nCount );
+	Out.fMeanMs		= fSum / nCount;
+	Out.fJitterMs	= sqrt( fVariance > 0 ? fVariance : 0 );
+	Out.fMinMs		= Sorted[0];
+	Out.fMaxMs		= Sorted[nCount - 1];
+	Out.fP99Ms		= Sorted[ std::min<ULONG>( nCount - 1, nCount * 99 / 100 ) ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : Now () (Private)
+// Desc : Current QPC time.
+//-----------------------------------------------------------------------------
+LONGLONG CFramePacer::Now() const
+{
+	LARGE_INTEGER Counter;
+	QueryPerformanceCounter( &Counter );
+	return Counter.QuadPart;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RecordFrame () (Private)
+// Desc : Stores the interval since the previous frame.
+//-----------------------------------------------------------------------------
+void CFramePacer::RecordFrame( LONGLONG nNow )
+{
+	if ( m_nLastFrame != 0 )
+		m_History[ m_nSamples++ % HISTORY ] = (float)( ( nNow - m_nLastFrame ) * 1000.0 / m_nFrequency );
+
+	m_nLastFrame = nNow;
+}
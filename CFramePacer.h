@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// File: CFramePacer.h
+//
+// Desc: Frame pacing for the main loop. Paces frames to a target rate with a
+//	   hybrid sleep-then-spin wait, sleeps while the app is inactive instead
+//	   of spinning, and keeps frame time jitter statistics.
+//-----------------------------------------------------------------------------
+
+#ifndef _CFRAMEPACER_H_
+#define _CFRAMEPACER_H_
+
+//-----------------------------------------------------------------------------
+// CFramePacer Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFramePacer (Class)
+// Desc : Decides when the next frame is due. Waits are done with
+//		MsgWaitForMultipleObjects so window messages (input) wake the loop
+//		immediately and never pick up extra latency from pacing.
+//-----------------------------------------------------------------------------
+class CFramePacer
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		HISTORY			= 256,		// Frame intervals kept for statistics
+		SPIN_US			= 1500,		// Spin for the final part of a wait
+		IDLE_TIMEOUT_MS	= 100,		// Tick rate while inactive
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Stats
+	{
+		double	fMeanMs;		// Mean frame interval
+		double	fJitterMs;		// Standard deviation of the interval
+		double	fMinMs;
+		double	fMaxMs;
+		double	fP99Ms;			// 99th percentile interval
+		ULONG	nMissed;		// Deadlines overrun by more than a frame
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFramePacer();
+	virtual ~CFramePacer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					SetTargetFPS( double fFPS );
+	double					GetTargetFPS( ) const { return m_fTargetFPS; }
+	bool					WaitForFrame( bool bActive );
+	void					GetStats( Stats& Out ) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	LONGLONG				Now( ) const;
+	void					RecordFrame( LONGLONG nNow );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	double					m_fTargetFPS;		// 0 runs uncapped
+	LONGLONG				m_nFrequency;		// QPC ticks per second
+	LONGLONG				m_nPeriod;			// Ticks per frame at the target rate
+	LONGLONG				m_nDeadline;		// When the next frame is due
+	LONGLONG				m_nLastFrame;		// Start of the previous frame, 0 if none
+
+	float					m_History[HISTORY];	// Recent frame intervals in ms
+	ULONG					m_nSamples;
+	ULONG					m_nMissed;
+};
+
+#endif // _CFRAMEPACER_H_
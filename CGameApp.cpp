@@ -13,6 +13,16 @@
 #include <fstream>
 extern HINSTANCE g_hInst;
 
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	// Script timing in simulation ticks (60 a second when paced)
+	const ULONG	CRASH_CHECK_TICKS	= 4;	// Was the 70 ms WM_TIMER
+	const ULONG	BACKGROUND_TICKS	= 6;	// Was 100 ms of GetTickCount
+}
+
 //-----------------------------------------------------------------------------
 // CGameApp Member Functions
 //-----------------------------------------------------------------------------
@@ -30,6 +40,21 @@ CGameApp::CGameApp()
 	m_pPlayer       = NULL;
 	m_pPlayer2      = NULL;
 	m_LastFrameRate = 0;
+	m_bSingleThreadedCompose = false;
+	m_nFrame		= 0;
+	m_bRenderQuit	= false;
+	m_hFrameReady	= NULL;
+	m_bHeadless		= false;
+	m_nBackgroundY	= 0;
+	m_nHitTests		= 0;
+	m_nHits			= 0;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		m_bAIControl[i]			= false;
+		m_LastInput[i].Direction	= 0;
+		m_LastInput[i].bShoot		= false;
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -48,6 +73,22 @@ CGameApp::~CGameApp()
 //-----------------------------------------------------------------------------
 bool CGameApp::InitInstance( LPCTSTR lpCmdLine, int iCmdShow )
 {
+	// "-soak <minutes> [log.csv]" plays itself in a hidden window and exits
+	// with 1 if resources trended upward, see CSoakTest
+	float fSoakMinutes = 0.0f;
+	char  szSoakLog[MAX_PATH] = "";
+	const char* szSoak = lpCmdLine ? strstr(lpCmdLine, "-soak") : NULL;
+	if (szSoak && sscanf_s(szSoak, "-soak %f %259s", &fSoakMinutes, szSoakLog, (unsigned)sizeof(szSoakLog)) >= 1)
+		m_bHeadless = true;
+	if (szSoakLog[0] == '-') szSoakLog[0] = '\0';
+
+	// "-capture <file> [every]" records presented frames, see CFrameCapture
+	int   nCaptureEvery = 1;
+	char  szCapture[MAX_PATH] = "";
+	const char* szCaptureArg = lpCmdLine ? strstr(lpCmdLine, "-capture") : NULL;
+	if (szCaptureArg)
+		sscanf_s(szCaptureArg, "-capture %259s %d", szCapture, (unsigned)sizeof(szCapture), &nCaptureEvery);
+
 	// Create the primary display device
 	if (!CreateDisplay()) { ShutDown(); return false; }
 	
@@ -62,6 +103,20 @@ bool CGameApp::InitInstance( LPCTSTR lpCmdLine, int iCmdShow )
 	// Set up all required game states
 	SetupGameState();
 
+	if (szCapture[0] && !m_Capture.Start(m_nViewWidth, m_nViewHeight, szCapture, nCaptureEvery))
+	{
+		ShutDown();
+		return false;
+	}
+
+	if (m_bHeadless)
+	{
+		// CPU players and no frame cap, the script adds rotations on top
+		m_bAIControl[0] = m_bAIControl[1] = true;
+		m_FramePacer.SetTargetFPS(0);
+		if (!m_Soak.Start(fSoakMinutes, szSoakLog[0] ? szSoakLog : NULL)) { ShutDown(); return false; }
+	}
+
 	// Success!
 	return true;
 }
@@ -109,8 +164,15 @@ bool CGameApp::CreateDisplay()
 	if (!m_hWnd)
 		return false;
 
-	// Show the window
-	ShowWindow(m_hWnd, SW_SHOWMAXIMIZED);
+	// Show the window. A headless window is never shown, so it gets the
+	// size message showing would have sent
+	if (m_bHeadless)
+	{
+		::GetClientRect( m_hWnd, &rc );
+		SendMessage(m_hWnd, WM_SIZE, SIZE_RESTORED, MAKELPARAM(rc.right - rc.left, rc.bottom - rc.top));
+	}
+	else
+		ShowWindow(m_hWnd, SW_SHOWMAXIMIZED);
 
 	// Success!!
 	return true;
@@ -135,7 +197,7 @@ int CGameApp::BeginGame()
 			TranslateMessage( &msg );
 			DispatchMessage ( &msg );
 		} 
-		else 
+		else if ( m_FramePacer.WaitForFrame( m_bActive ) )
 		{
 			// Advance Game Frame.
 			FrameAdvance();
@@ -144,7 +206,7 @@ int CGameApp::BeginGame()
 	
 	} // Until quit message is receieved
 
-	return 0;
+	return (int)msg.wParam;
 }
 
 //-----------------------------------------------------------------------------
@@ -201,8 +263,6 @@ LRESULT CALLBACK CGameApp::StaticWndProc(HWND hWnd, UINT Message, WPARAM wParam,
 //-----------------------------------------------------------------------------
 LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam )
 {
-	static UINT			fTimer;	
-	
 	// Determine message type
 	switch (Message)
 	{
@@ -232,7 +292,11 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 				// Store new viewport sizes
 				m_nViewWidth  = LOWORD( lParam );
 				m_nViewHeight = HIWORD( lParam );
-		
+
+				// Culling and world bounds follow the client area
+				m_Camera.SetViewport( m_nViewWidth, m_nViewHeight );
+				if ( m_pBBuffer )
+					m_FlowField.Init( &m_ThreadPool, m_Camera.GetWorldWidth(), m_Camera.GetWorldHeight(), 32 );
 			
 			} // End if !Minimized
 
@@ -250,24 +314,25 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			break;
 
 		case WM_KEYDOWN:
+			// First press only, auto repeat would measure the repeat delay
+			if (!(lParam & (1 << 30)))
+				m_Latency.OnInput(CInputLatency::ActionForKey(wParam), m_Latency.Now());
+
 			switch (wParam)
 			{
 			case VK_ESCAPE:
 				PostQuitMessage(0);
 				break;
 			case VK_RETURN:
-				fTimer = SetTimer(m_hWnd, 1, 70, NULL);
 				m_pPlayer->Explode();
 				m_pPlayer->DecreaseLives();
 				break;
 			case 'Q':
-				fTimer = SetTimer(m_hWnd, 1, 70, NULL);
 				m_pPlayer2->Explode();
 				m_pPlayer2->DecreaseLives();
 				break;
 			case 'H':
-				m_pPlayer2->Shoot(-1);
-				
+				m_pPlayer2->Shoot();
 				break;
 			case 'O':
 				m_pPlayer->RotateLeft();
@@ -276,7 +341,7 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 				m_pPlayer2->RotateLeft();
 				break;
 			case VK_SPACE:
-				m_pPlayer->Shoot(1);			
+				m_pPlayer->Shoot();
 				break;
 			case 'S':
 				SaveGame(m_pPlayer, m_pPlayer2);
@@ -284,43 +349,49 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			case 'L':
 				LoadGame(m_pPlayer, m_pPlayer2);
 				break;
+			case VK_F2:
+				// Toggle CPU control of player 2
+				m_bAIControl[1] = !m_bAIControl[1];
+				break;
+			case VK_F3:
+				// Toggle CPU control of player 1 (both on gives an AI-vs-AI match)
+				m_bAIControl[0] = !m_bAIControl[0];
+				break;
+			case VK_F5:
+				// Toggle between paced 60 FPS and uncapped
+				m_FramePacer.SetTargetFPS( m_FramePacer.GetTargetFPS() > 0 ? 0 : 60 );
+				break;
+			case VK_F4:
+				// Toggle single threaded compositing, output must not change
+				m_bSingleThreadedCompose = !m_bSingleThreadedCompose;
+				m_Compositor.SetSingleThreaded(m_bSingleThreadedCompose);
+				break;
+			case VK_F6:
+				// Toggle the per frame resource log
+				if (m_Telemetry.IsLogging())
+					m_Telemetry.CloseLog();
+				else
+					m_Telemetry.OpenLog("telemetry.csv");
+				break;
+			case VK_F7:
+				// Input to present latency per action, also to the debugger
+				m_Latency.WriteReport("latency.txt");
+				break;
+			case VK_F9:
+				// Toggle the HUD
+				m_Hud.SetVisible(!m_Hud.IsVisible());
+				break;
+			case VK_F8:
+				// Toggle recording every presented frame
+				if (m_Capture.IsRunning())
+					m_Capture.Stop();
+				else if (!m_Capture.Start(m_nViewWidth, m_nViewHeight, "capture.y4m"))
+					OutputDebugStringA("Capture: could not start\n");
+				break;
 
 			}
 			break;
 
-		case WM_TIMER:
-			switch (wParam)
-			{
-			case 1:
-				if (!m_pPlayer->AdvanceExplosion()) {
-					fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-					
-				}
-
-			case 2:
-				if (!m_pPlayer2->AdvanceExplosion()) {
-					fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-					
-
-				}
-			case 3:
-				
-				if (m_pPlayer->Collision(m_pPlayer, m_pPlayer2)) {
-					fTimer = SetTimer(m_hWnd, 1, 70, NULL);
-					m_pPlayer->Explode();
-					m_pPlayer->DecreaseLives();
-					m_pPlayer->Position() = Vec2(100, 400);
-					m_pPlayer2->Explode();
-					m_pPlayer2->DecreaseLives();
-					m_pPlayer2->Position() = Vec2(600, 0);
-					
-					
-				}
-					
-
-			}
-				break;
-			
 		case WM_COMMAND:
 			break;
 
@@ -339,27 +410,261 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 bool CGameApp::BuildObjects()
 {
 	m_pBBuffer = new BackBuffer(m_hWnd, m_nViewWidth, m_nViewHeight);
-	m_pPlayer = new CPlayer(m_pBBuffer,1);
-	m_pPlayer2 = new  CPlayer(m_pBBuffer,2);
 
-	
-	if(!m_imgBackground.LoadBitmapFromFile("data/background.bmp", GetDC(m_hWnd)))
+	// Room for both planes and plenty of bullets, so Create never grows the
+	// arrays mid game
+	m_Kinematics.Reserve(256);
+
+	// Per frame scratch for the game thread, grows itself if a frame needs more
+	if (!m_FrameArena.Init(64 * 1024)) return false;
+
+	// Gameplay scripts, a handful per player plus the game's own
+	m_Scripts.Reserve(64);
+
+	// Loading runs on the pool too, so start it first
+	m_ThreadPool.Start();
+
+	// Jobs each take their own window DC, GetDC is safe from any thread
+	HWND hWnd = m_hWnd;
+
+	// Optional, assets are read from loose files when there is no pack
+	int nPack = m_Loader.Add("assets.pak", [this] {
+		CTelemetry::Scope Tag(CTelemetry::SUB_ASSETS);
+		return m_Assets.Open("data/assets.pak");
+	}, false);
+
+	// Optional, players fall back to their own bitmaps when it is missing
+	int nAtlas = m_Loader.Add("atlas", [this, hWnd] {
+		CTelemetry::Scope Tag(CTelemetry::SUB_GRAPHICS);
+		HDC hDC = GetDC(hWnd);
+		bool bOk = m_Atlas.Load(m_Assets, "data/atlas.bmp", "data/atlasmask.bmp", "data/atlas.idx", hDC);
+		ReleaseDC(hWnd, hDC);
+		return bOk;
+	}, false, { nPack });
+
+	m_Loader.Add("background", [this, hWnd] {
+		CTelemetry::Scope Tag(CTelemetry::SUB_GRAPHICS);
+		HDC hDC = GetDC(hWnd);
+		bool bOk = m_imgBackground.LoadBitmapFromFile("data/background.bmp", hDC);
+		ReleaseDC(hWnd, hDC);
+		return bOk;
+	}, true);
+
+	// Pixel masks come from the atlas alpha, or the source bitmaps without it
+	m_Loader.Add("collision masks", [this] {
+		CTelemetry::Scope Tag(CTelemetry::SUB_GRAPHICS);
+		BuildCollisionMasks();
+		return true;
+	}, true, { nAtlas });
+
+	// Players look their atlas regions up on construction, which also makes
+	// the pack and atlas part of the first frame
+	m_Loader.Add("player 1", [this] {
+		CTelemetry::Scope Tag(CTelemetry::SUB_ENTITIES);
+		m_pPlayer = new CPlayer(m_pBBuffer, KIND_PLAYER_1);
+		return true;
+	}, true, { nAtlas });
+	m_Loader.Add("player 2", [this] {
+		CTelemetry::Scope Tag(CTelemetry::SUB_ENTITIES);
+		m_pPlayer2 = new CPlayer(m_pBBuffer, KIND_PLAYER_2);
+		return true;
+	}, true, { nAtlas });
+
+	// Sounds only need decoding before they are first played
+	static const char* Sounds[] = { "data/jet-start.wav", "data/jet-stop.wav", "data/jet-cabin.wav", "data/explosion.wav" };
+	for (const char* szSound : Sounds)
+	{
+		m_Loader.Add(szSound, [this, szSound] {
+			CTelemetry::Scope Tag(CTelemetry::SUB_ASSETS);
+			size_t nSize;
+			return m_Assets.GetData(szSound, nSize) != NULL;
+		}, false, { nPack });
+	}
+
+	m_Loader.Start(&m_ThreadPool);
+
+	// Flow field covers the world bounds players are clamped to in CPlayer::Move
+	m_FlowField.Init(&m_ThreadPool, m_Camera.GetWorldWidth(), m_Camera.GetWorldHeight(), 32);
+
+	// 2ms of lookahead per tick each
+	m_AI[0].Init(&m_ThreadPool, 0, 2.0);
+	m_AI[1].Init(&m_ThreadPool, 1, 2.0);
+
+	// The first frame only needs the required set, sounds keep loading.
+	// The window keeps pumping messages meanwhile
+	int  nShown = -1;
+	bool bPump  = true;
+	bool bLoaded = m_Loader.WaitRequired([this, &nShown, &bPump](int nDone, int nTotal, const char* szLast) {
+		if (nDone != nShown)
+		{
+			TCHAR TitleBuffer[ 255 ];
+			sprintf_s(TitleBuffer, _T("Game : Loading %d/%d %s"), nDone, nTotal, szLast);
+			SetWindowText(m_hWnd, TitleBuffer);
+			nShown = nDone;
+		}
+		if (bPump) bPump = PumpLoadingMessages();
+	});
+
+	if (!bLoaded || !m_pPlayer || !m_pPlayer2)
 		return false;
 
+	// Software compositor only pays off with the atlas, GDI handles the rest
+	if (m_Atlas.IsLoaded())
+	{
+		HDC hDC = GetDC(m_hWnd);
+		m_Compositor.Init(hDC, m_nViewWidth, m_nViewHeight, &m_ThreadPool);
+		ReleaseDC(m_hWnd, hDC);
+	}
+
+	// HUD font lives in the atlas, without it the title bar shows the stats
+	if (m_Hud.Init(m_Atlas))
+		BuildHud();
+
+	// Atlas draws are self contained, so rendering can leave this thread.
+	// A missing region makes CPlayer queue its live Sprite instead, which
+	// only this thread may touch, so then everything stays here.
+	if (m_Atlas.IsLoaded() && m_Hud.IsReady() && m_pPlayer->HasAtlasRegions() && m_pPlayer2->HasAtlasRegions())
+		StartRenderThread();
+
 	// Success!
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Name : PumpLoadingMessages () (Private)
+// Desc : Dispatches pending window messages while BuildObjects waits for
+//		the loader. Input is dropped, the players it drives do not exist
+//		yet. Returns false once WM_QUIT arrived; it is posted again for
+//		BeginGame and pumping stops.
+//-----------------------------------------------------------------------------
+bool CGameApp::PumpLoadingMessages()
+{
+	MSG msg;
+	while ( PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) )
+	{
+		if (msg.message == WM_QUIT)
+		{
+			PostQuitMessage((int)msg.wParam);
+			return false;
+		}
+
+		if ((msg.message >= WM_KEYFIRST && msg.message <= WM_KEYLAST) ||
+			(msg.message >= WM_MOUSEFIRST && msg.message <= WM_MOUSELAST))
+			continue;
+
+		TranslateMessage( &msg );
+		DispatchMessage ( &msg );
+	}
+	return true;
+}
+
 //-----------------------------------------------------------------------------
 // Name : SetupGameState ()
 // Desc : Sets up all the initial states required by the game.
 //-----------------------------------------------------------------------------
 void CGameApp::SetupGameState()
 {
-	m_pPlayer->Position() = Vec2(100, 400);
-	m_pPlayer2->Position() = Vec2(600, 0);
+	m_FramePacer.SetTargetFPS(60);
 
-	
+	m_pPlayer->Respawn();
+	m_pPlayer2->Respawn();
+
+	m_nBackgroundY = m_imgBackground.Height();
+	m_Scripts.Spawn(BackgroundScript());
+	m_Scripts.Spawn(CrashScript());
+}
+
+//-----------------------------------------------------------------------------
+// Name : CrashScript () (Private)
+// Desc : Watches for the planes running into each other. Both explode, lose
+//		a life and start over at their spawn points; watching resumes once
+//		an explosion has burnt out.
+//-----------------------------------------------------------------------------
+CScript CGameApp::CrashScript()
+{
+	for (;;)
+	{
+		co_await CScriptRuntime::WaitTicks(CRASH_CHECK_TICKS);
+		m_nHitTests++;
+		if (!m_pPlayer->Collision(m_pPlayer, m_pPlayer2))
+			continue;
+		m_nHits++;
+
+		m_pPlayer->Explode();
+		m_pPlayer->DecreaseLives();
+		m_pPlayer->Respawn();
+		m_pPlayer2->Explode();
+		m_pPlayer2->DecreaseLives();
+		m_pPlayer2->Respawn();
+
+		co_await CScriptRuntime::WaitEvent(EVENT_EXPLOSION_DONE);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BackgroundScript () (Private)
+// Desc : Scrolls the background 10 pixels every BACKGROUND_TICKS, wrapping
+//		at the top.
+//-----------------------------------------------------------------------------
+CScript CGameApp::BackgroundScript()
+{
+	for (;;)
+	{
+		co_await CScriptRuntime::WaitTicks(BACKGROUND_TICKS);
+		m_nBackgroundY -= 10;
+		if (m_nBackgroundY < 0)
+			m_nBackgroundY = m_imgBackground.Height();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildHud () (Private)
+// Desc : Lays out the HUD lines, top left, one run each.
+//-----------------------------------------------------------------------------
+void CGameApp::BuildHud()
+{
+	int y = 8, nLine = m_Hud.GetLineHeight() + 2;
+
+	m_HudRuns[HUD_LIVES_1]		= m_Hud.AddRun(8, y, "P1 lives ");				y += nLine;
+	m_HudRuns[HUD_LIVES_2]		= m_Hud.AddRun(8, y, "P2 lives ");				y += nLine + nLine / 2;
+	m_HudRuns[HUD_FPS]			= m_Hud.AddRun(8, y, "FPS ");					y += nLine;
+	m_HudRuns[HUD_FRAME_MS]		= m_Hud.AddRun(8, y, "Frame ", 1, " ms");		y += nLine;
+	m_HudRuns[HUD_P99_MS]		= m_Hud.AddRun(8, y, "p99 ", 2, " ms");			y += nLine;
+	m_HudRuns[HUD_JITTER_MS]	= m_Hud.AddRun(8, y, "Jitter ", 2, " ms");		y += nLine;
+	m_HudRuns[HUD_BODIES]		= m_Hud.AddRun(8, y, "Bodies ");				y += nLine;
+	m_HudRuns[HUD_SCRIPTS]		= m_Hud.AddRun(8, y, "Scripts ");				y += nLine;
+	m_HudRuns[HUD_HIT_TESTS]	= m_Hud.AddRun(8, y, "Hit tests/tick ");		y += nLine;
+	m_HudRuns[HUD_HITS]			= m_Hud.AddRun(8, y, "Hits/tick ");
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateHud () (Private)
+// Desc : Feeds this frame's values to the HUD; runs whose value did not
+//		change cost a compare. Pacing stats sort a history, so they are only
+//		read when the frame rate (updated once a second) changes.
+//-----------------------------------------------------------------------------
+void CGameApp::UpdateHud()
+{
+	if (!m_Hud.IsReady()) return;
+
+	m_Hud.SetValue(m_HudRuns[HUD_LIVES_1], m_pPlayer->GetLives());
+	m_Hud.SetValue(m_HudRuns[HUD_LIVES_2], m_pPlayer2->GetLives());
+	m_Hud.SetValue(m_HudRuns[HUD_FRAME_MS], m_Timer.GetTimeElapsed() * 1000.0);
+	m_Hud.SetValue(m_HudRuns[HUD_BODIES], (double)m_Kinematics.GetCount());
+	m_Hud.SetValue(m_HudRuns[HUD_SCRIPTS], (double)m_Scripts.GetCount());
+	m_Hud.SetValue(m_HudRuns[HUD_HIT_TESTS], m_nHitTests);
+	m_Hud.SetValue(m_HudRuns[HUD_HITS], m_nHits);
+
+	if (m_LastFrameRate != m_Timer.GetFrameRate())
+	{
+		m_LastFrameRate = m_Timer.GetFrameRate();
+
+		CFramePacer::Stats Pacing;
+		m_FramePacer.GetStats(Pacing);
+		m_Hud.SetValue(m_HudRuns[HUD_FPS], m_LastFrameRate);
+		m_Hud.SetValue(m_HudRuns[HUD_P99_MS], Pacing.fP99Ms);
+		m_Hud.SetValue(m_HudRuns[HUD_JITTER_MS], Pacing.fJitterMs);
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -369,24 +674,48 @@ void CGameApp::SetupGameState()
 //-----------------------------------------------------------------------------
 void CGameApp::ReleaseObjects()
 {
+	// The render thread uses everything below, including the pool
+	StopRenderThread();
+
+	// Drains to disk, and reads the back buffer until then
+	m_Capture.Stop();
+
+	// Let any background job finish before the objects it reads go away
+	m_Loader.Clear();
+	m_ThreadPool.Stop();
+
+	// Scripts point at the players
+	m_Scripts.Clear();
+
+	// Players draw into the back buffer, let them go first
 	if (m_pPlayer != NULL)
 	{
 		delete m_pPlayer;
 		m_pPlayer = NULL;
 	}
 
-	if (m_pBBuffer != NULL)
-	{
-		delete m_pBBuffer;
-		m_pBBuffer = NULL;
-	}
-
 	if (m_pPlayer2 != NULL)
 	{
 		delete m_pPlayer2;
 		m_pPlayer2 = NULL;
 	}
 
+	m_FrameArena.Release();
+	m_Compositor.Release();
+	m_Atlas.Release();
+	for (CCollisionMask& Mask : m_PlaneMasks) Mask.Release();
+	m_BulletMask.Release();
+
+	// Sounds play straight from pack memory, stop them before it goes
+	PlaySound(NULL, NULL, 0);
+	m_Assets.Close();
+
+	if (m_pBBuffer != NULL)
+	{
+		delete m_pBBuffer;
+		m_pBBuffer = NULL;
+	}
+
 	
 	
 
@@ -407,17 +736,26 @@ void CGameApp::FrameAdvance()
 	// Skip if app is inactive
 	if ( !m_bActive ) return;
 	
-	// Get / Display the framerate
-	if ( m_LastFrameRate != m_Timer.GetFrameRate() )
+	// Get / Display the framerate, in the title bar only when there is no HUD
+	if ( !m_Hud.IsReady() && m_LastFrameRate != m_Timer.GetFrameRate() )
 	{
+		CFramePacer::Stats Pacing;
+		m_FramePacer.GetStats( Pacing );
+
 		m_LastFrameRate = m_Timer.GetFrameRate( FrameRate, 50 );
-		sprintf_s(TitleBuffer, _T("Game : %s  Lives: %d-%d"), FrameRate,m_pPlayer->GetLives(), m_pPlayer2->GetLives());
+		sprintf_s(TitleBuffer, _T("Game : %s  Lives: %d-%d  Jitter: %.2fms  p99: %.2fms"), FrameRate,m_pPlayer->GetLives(), m_pPlayer2->GetLives(), Pacing.fJitterMs, Pacing.fP99Ms);
 		SetWindowText( m_hWnd, TitleBuffer );
 
 	} // End if Frame Rate Altered
 
-	//Game is ended when the lives of one player reach 0
-	if (!m_pPlayer->GetLives())
+	//Game is ended when the lives of one player reach 0, a soak run just
+	//starts another round
+	if (m_bHeadless && (!m_pPlayer->GetLives() || !m_pPlayer2->GetLives()))
+	{
+		m_pPlayer->SetLives(3);
+		m_pPlayer2->SetLives(3);
+	}
+	else if (!m_pPlayer->GetLives())
 	{
 		MessageBox(m_hWnd, "Second Player Wins", "Game over", MB_OK);
 		PostQuitMessage(0);
@@ -429,14 +767,42 @@ void CGameApp::FrameAdvance()
 	}
 	//end game
 
-	// Poll & Process input devices
-	ProcessInput();
+	// Scripted soak input, on top of the CPU players
+	ULONG SoakActions = m_Soak.IsRunning() ? m_Soak.GetActions(m_nFrame) : 0;
+	if (SoakActions & CSoakTest::ACTION_ROTATE_1) m_pPlayer->RotateLeft();
+	if (SoakActions & CSoakTest::ACTION_ROTATE_2) m_pPlayer2->RotateLeft();
+
+	// Poll & Process input devices (the CPU players think in here)
+	{
+		CTelemetry::Scope Tag(CTelemetry::SUB_AI);
+		ProcessInput();
+	}
 
 	// Animate the game objects
-	AnimateObjects();
+	{
+		CTelemetry::Scope Tag(CTelemetry::SUB_ENTITIES);
+		AnimateObjects();
+	}
 
 	// Drawing the game objects
-	DrawObjects();
+	{
+		CTelemetry::Scope Tag(CTelemetry::SUB_GRAPHICS);
+		UpdateHud();
+		DrawObjects();
+	}
+
+	// Nothing allocated from the frame arena outlives the frame
+	m_FrameArena.Reset();
+
+	if (m_Telemetry.IsLogging())
+	{
+		CTelemetry::Sample Sample;
+		CTelemetry::Capture(Sample, m_nFrame);
+		m_Telemetry.WriteSample(Sample);
+	}
+
+	if (m_Soak.IsRunning() && !m_Soak.Update(m_nFrame))
+		PostQuitMessage(m_Soak.Finish() ? 0 : 1);
 }
 
 //-----------------------------------------------------------------------------
@@ -470,7 +836,35 @@ void CGameApp::ProcessInput()
 	if (pKeyBuffer['A'] & 0xF0) Direction2 |= CPlayer::DIR_LEFT;
 	if (pKeyBuffer['D'] & 0xF0) Direction2 |= CPlayer::DIR_RIGHT;
 	
-	
+
+	// CPU players replace the keyboard input with their search result
+	if (m_bAIControl[0] || m_bAIControl[1])
+	{
+		CSimState State;
+		CaptureSimState(State);
+
+		SimInput Human[2] = { { Direction, false }, { Direction2, false } };
+		for (int i = 0; i < 2; ++i)
+		{
+			if (!m_bAIControl[i]) continue;
+
+			SimInput Input = m_AI[i].Think(State, m_bAIControl[i ^ 1] ? m_LastInput[i ^ 1] : Human[i ^ 1]);
+			if (i == 0)
+			{
+				Direction = Input.Direction;
+				if (Input.bShoot) m_pPlayer->Shoot();
+			}
+			else
+			{
+				Direction2 = Input.Direction;
+				if (Input.bShoot) m_pPlayer2->Shoot();
+			}
+			m_LastInput[i] = Input;
+		}
+	}
+	m_LastInput[0].Direction = Direction;
+	m_LastInput[1].Direction = Direction2;
+
 	// Move the player
 	m_pPlayer->Move(Direction);
 	m_pPlayer2->Move(Direction2);
@@ -498,74 +892,217 @@ void CGameApp::ProcessInput()
 //-----------------------------------------------------------------------------
 void CGameApp::AnimateObjects()
 {
+	// Per tick counters for the HUD
+	m_nHitTests	= 0;
+	m_nHits		= 0;
+
+	// Scripts due this tick first, reloads count down before anyone fires
+	m_Scripts.Tick();
+
 	m_pPlayer->Update(m_Timer.GetTimeElapsed());
 	m_pPlayer2->Update(m_Timer.GetTimeElapsed());
-	
 
+	// Rebuilds in the background only when a player changed cell
+	Vec2 Targets[2] = { m_pPlayer->Position(), m_pPlayer2->Position() };
+	m_FlowField.SetTargets(Targets, 2);
+
+	// Bullets fly along each plane's aim, see ENTITY_TYPES
+	m_pPlayer->fire();
+	m_pPlayer2->fire();
 
+	// Swept against the motion about to be integrated, so no step size can
+	// skip a plane
+	float dt = m_Timer.GetTimeElapsed();
+	m_nHitTests += (ULONG)(m_pPlayer->GetBulletCount() + m_pPlayer2->GetBulletCount());
+	if (m_pPlayer->SweepBullets(m_pPlayer2, dt)) {
+		m_pPlayer2->Explode();
+		m_pPlayer2->DecreaseLives();
+		m_nHits++;
+	}
+
+	if (m_pPlayer2->SweepBullets(m_pPlayer, dt)) {
+		m_pPlayer->Explode();
+		m_pPlayer->DecreaseLives();
+		m_nHits++;
+	}
+
+	// Planes and bullets move together in one pass
+	m_Kinematics.Integrate(dt);
 }
 
 //-----------------------------------------------------------------------------
 // Name : DrawObjects () (Private)
-// Desc : Draws the game objects
+// Desc : Records the frame into a render snapshot. With a render thread the
+//		snapshot is published and this returns without waiting, otherwise
+//		it is presented right away. No game state changes here.
 //-----------------------------------------------------------------------------
 void CGameApp::DrawObjects()
 {
-	
-	m_pBBuffer->reset();
-	DrawBackground();
-	
-	
-	m_pPlayer->Draw();
-	m_pPlayer2->Draw();
-	
-	
-	if (m_pPlayer->bulletCollision(m_pPlayer,m_pPlayer2,1)) {
-		m_pPlayer2->Explode();
-		m_pPlayer2->DecreaseLives();
-		
-		
-	}
+	RenderSnapshot& Snapshot = m_Snapshots.GetWriteBuffer();
+	CRenderQueue& Queue = Snapshot.Queue;
 
-	if (m_pPlayer->bulletCollision(m_pPlayer2, m_pPlayer,2)) {
-		m_pPlayer->Explode();
-		m_pPlayer->DecreaseLives();
-		
+	Queue.Begin();
+
+	DrawBackground(Queue);
+	m_pPlayer->Draw(Queue);
+	m_pPlayer2->Draw(Queue);
+	m_pPlayer->DrawBullets(Queue);
+	m_pPlayer2->DrawBullets(Queue);
+	m_Hud.Draw(Queue);
 
+	Queue.Sort();
+	Snapshot.nFrame = ++m_nFrame;
+	m_Latency.OnSimulated(Snapshot.nFrame);
+
+	if (m_RenderThread.joinable())
+	{
+		m_Snapshots.Publish();
+		SetEvent(m_hFrameReady);
+	}
+	else
+		PresentSnapshot(Snapshot);
+}
+
+//-----------------------------------------------------------------------------
+// Name : PresentSnapshot () (Private)
+// Desc : Draws a snapshot into the back buffer and presents it. Called on
+//		the render thread when it runs, on the game thread otherwise.
+//-----------------------------------------------------------------------------
+void CGameApp::PresentSnapshot(const RenderSnapshot& Snapshot)
+{
+	if (m_Compositor.IsReady())
+	{
+		// Tiles are rasterised in parallel and copied over the whole back buffer
+		m_Compositor.Compose(Snapshot.Queue, m_Atlas, m_pBBuffer->getDC());
+	}
+	else
+	{
+		m_pBBuffer->reset();
+		Snapshot.Queue.Execute(m_pBBuffer->getDC(), m_Atlas);
 	}
-	if (m_pPlayer->rotateDirection == 1)
-		m_pPlayer->fire(-1, 0);
-	if (m_pPlayer->rotateDirection == 2)
-		m_pPlayer->fire(1, 0);
-	if (m_pPlayer->rotateDirection == 4)
-		m_pPlayer->fire(0, -1);
-	if (m_pPlayer->rotateDirection == 8)
-		m_pPlayer->fire(0, 1);
-
-	m_pPlayer2->fire(1,0);
-	
 	m_pBBuffer->present();
-	
+	m_Latency.OnPresented(Snapshot.nFrame);
+	m_Capture.Capture(m_pBBuffer->getDC(), Snapshot.nFrame);
+}
+
+//-----------------------------------------------------------------------------
+// Name : StartRenderThread () (Private)
+// Desc : Moves PresentSnapshot onto its own thread.
+//-----------------------------------------------------------------------------
+void CGameApp::StartRenderThread()
+{
+	if (m_RenderThread.joinable()) return;
+
+	// Without the event frames are simply presented on this thread
+	m_hFrameReady	= CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (!m_hFrameReady) return;
+	CTelemetry::TrackHandles(CTelemetry::SUB_GRAPHICS, 1);
+	m_bRenderQuit	= false;
+	m_RenderThread	= std::thread(&CGameApp::RenderThreadProc, this);
+}
+
+//-----------------------------------------------------------------------------
+// Name : StopRenderThread () (Private)
+// Desc : Joins the render thread, if it is running.
+//-----------------------------------------------------------------------------
+void CGameApp::StopRenderThread()
+{
+	if (!m_RenderThread.joinable()) return;
 
+	m_bRenderQuit = true;
+	SetEvent(m_hFrameReady);
+	m_RenderThread.join();
+
+	CloseHandle(m_hFrameReady);
+	CTelemetry::TrackHandles(CTelemetry::SUB_GRAPHICS, -1);
+	m_hFrameReady = NULL;
 }
 
-void CGameApp::DrawBackground()
+//-----------------------------------------------------------------------------
+// Name : RenderThreadProc () (Private)
+// Desc : Render thread body. Always draws the newest complete snapshot;
+//		snapshots published while it was busy are simply skipped.
+//-----------------------------------------------------------------------------
+void CGameApp::RenderThreadProc()
 {
-	static int currentY =m_imgBackground.Height();
+	CTelemetry::Scope Tag(CTelemetry::SUB_GRAPHICS);
+
+	while (!m_bRenderQuit)
+	{
+		WaitForSingleObject(m_hFrameReady, 100);
+
+		if (m_Snapshots.Acquire())
+			PresentSnapshot(m_Snapshots.GetReadBuffer());
+	}
+}
 
-	static size_t lastTime = ::GetTickCount();
-	size_t currentTime = ::GetTickCount();
+//-----------------------------------------------------------------------------
+// Name : DrawBackground () (Private)
+// Desc : Queues the background at the scroll BackgroundScript keeps.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawBackground(CRenderQueue& Queue)
+{
+	Queue.AddImage(CRenderQueue::LAYER_BACKGROUND, &m_imgBackground, 0, m_nBackgroundY);
+}
 
-	if (currentTime - lastTime > 100)
+//-----------------------------------------------------------------------------
+// Name : CaptureSimState () (Private)
+// Desc : Snapshots both players into a CSimState for AI rollouts.
+//-----------------------------------------------------------------------------
+void CGameApp::CaptureSimState(CSimState& State)
+{
+	State.Reset((float)m_Camera.GetWorldWidth(), (float)m_Camera.GetWorldHeight());
+	m_pPlayer->SaveSimState(State, 0);
+	m_pPlayer2->SaveSimState(State, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildCollisionMasks () (Private)
+// Desc : Builds the pixel masks for each plane rotation and the bullet.
+//		Uses the atlas alpha when the atlas loaded, otherwise decodes the
+//		bitmaps the Sprite fallbacks draw with.
+//-----------------------------------------------------------------------------
+bool CGameApp::BuildCollisionMasks()
+{
+	bool bOk = true;
+	for (int i = 0; i < FACING_COUNT; ++i)
 	{
-		lastTime = currentTime;
-		currentY -= 10;
-		if (currentY < 0)
-			currentY = m_imgBackground.Height();
+		int nRegion = m_Atlas.IsLoaded() ? m_Atlas.Find(FACING_TYPES[i].szRegion) : -1;
+		if (nRegion >= 0)
+		{
+			const RECT& rc = m_Atlas.GetRect(nRegion);
+			m_PlaneMasks[i].BuildFromAlpha((const uint32_t*)m_Atlas.GetPixels() + rc.top * m_Atlas.GetWidth() + rc.left,
+										   m_Atlas.GetWidth(), rc.right - rc.left, rc.bottom - rc.top);
+			continue;
+		}
+
+		CBmpDecoder::Image Image;
+		if (m_Assets.DecodeBitmap(FACING_TYPES[i].szBitmap, Image, CBmpDecoder::KeyFromCOLORREF(RGB(0xff, 0x00, 0xff))))
+			m_PlaneMasks[i].BuildFromAlpha(&Image.Pixels[0], Image.nWidth, Image.nWidth, Image.nHeight);
+		else
+			bOk = false;
 	}
 
-	m_imgBackground.Paint(m_pBBuffer->getDC(), 0, currentY);
-	
+	// Every weapon shares the cannon's bullet mask for now
+	const WeaponType& Cannon = WEAPON_TYPES[WEAPON_CANNON];
+	int nBullet = m_Atlas.IsLoaded() ? m_Atlas.Find(Cannon.szRegion) : -1;
+	if (nBullet >= 0)
+	{
+		const RECT& rc = m_Atlas.GetRect(nBullet);
+		m_BulletMask.BuildFromAlpha((const uint32_t*)m_Atlas.GetPixels() + rc.top * m_Atlas.GetWidth() + rc.left,
+									m_Atlas.GetWidth(), rc.right - rc.left, rc.bottom - rc.top);
+	}
+	else
+	{
+		CBmpDecoder::Image Mask;
+		if (m_Assets.DecodeBitmap(Cannon.szMask, Mask))
+			m_BulletMask.BuildFromMask(&Mask.Pixels[0], Mask.nWidth, Mask.nWidth, Mask.nHeight);
+		else
+			bOk = false;
+	}
+
+	// Missing masks just leave collision at box accuracy
+	return bOk;
 }
 
 void CGameApp::SaveGame(CPlayer* Player1, CPlayer* Player2) {
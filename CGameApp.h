@@ -17,6 +17,28 @@
 #include "CPlayer.h"
 #include "BackBuffer.h"
 #include "ImageFile.h"
+#include "CThreadPool.h"
+#include "CFlowField.h"
+#include "CAIOpponent.h"
+#include "CCamera.h"
+#include "CAssetPack.h"
+#include "CAssetLoader.h"
+#include "CSpriteAtlas.h"
+#include "CCollisionMask.h"
+#include "CRenderQueue.h"
+#include "CTileCompositor.h"
+#include "CTripleBuffer.h"
+#include "CFramePacer.h"
+#include "CKinematics.h"
+#include "CFrameArena.h"
+#include "CTelemetry.h"
+#include "CSoakTest.h"
+#include "CInputLatency.h"
+#include "CFrameCapture.h"
+#include "CScriptRuntime.h"
+#include "CHud.h"
+#include <thread>
+#include <atomic>
 
 
 //-----------------------------------------------------------------------------
@@ -34,6 +56,20 @@
 class CGameApp
 {
 public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum SCRIPT_EVENT
+	{
+		EVENT_EXPLOSION_DONE,			// A plane's explosion animation ended
+	};
+
+	enum HUD_LINE
+	{
+		HUD_LIVES_1, HUD_LIVES_2, HUD_FPS, HUD_FRAME_MS, HUD_P99_MS, HUD_JITTER_MS,
+		HUD_BODIES, HUD_SCRIPTS, HUD_HIT_TESTS, HUD_HITS, HUD_COUNT
+	};
+
 	//-------------------------------------------------------------------------
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
@@ -48,6 +84,16 @@ public:
 	int		 BeginGame( );
 	bool		ShutDown( );
 	BackBuffer*				m_pBBuffer;
+	const CFlowField&		GetFlowField( ) const { return m_FlowField; }
+	const CCamera&			GetCamera( ) const { return m_Camera; }
+	const CSpriteAtlas&		GetAtlas( ) const { return m_Atlas; }
+	CAssetPack&				GetAssets( ) { return m_Assets; }
+	CKinematics&			GetKinematics( ) { return m_Kinematics; }
+	const CKinematics&		GetKinematics( ) const { return m_Kinematics; }
+	CFrameArena&			GetFrameArena( ) { return m_FrameArena; }
+	CScriptRuntime&			GetScripts( ) { return m_Scripts; }
+	const CCollisionMask&	GetPlaneMask( FACING Facing ) const { return m_PlaneMasks[Facing]; }
+	const CCollisionMask&	GetBulletMask( ) const { return m_BulletMask; }
 	
 	
 private:
@@ -55,6 +101,7 @@ private:
 	// Private Functions for This Class
 	//-------------------------------------------------------------------------
 	bool		BuildObjects	  ( );
+	bool		PumpLoadingMessages( );
 	void		ReleaseObjects	( );
 	void		FrameAdvance	  ( );
 	bool		CreateDisplay	 ( );
@@ -63,9 +110,19 @@ private:
 	void		AnimateObjects	( );
 	void		DrawObjects	   ( );
 	void		ProcessInput	  ( );
-	void        DrawBackground();
+	void        DrawBackground(CRenderQueue& Queue);
 	void        SaveGame(CPlayer* Player1, CPlayer* Player2);
 	void        LoadGame(CPlayer* Player1, CPlayer* Player2);
+	void		CaptureSimState	( CSimState& State );
+	bool		BuildCollisionMasks( );
+	void		StartRenderThread ( );
+	void		StopRenderThread  ( );
+	void		RenderThreadProc  ( );
+	void		PresentSnapshot	  ( const RenderSnapshot& Snapshot );
+	CScript		CrashScript		  ( );
+	CScript		BackgroundScript  ( );
+	void		BuildHud		  ( );
+	void		UpdateHud		  ( );
 
 	//-------------------------------------------------------------------------
 	// Private Static Functions For This Class
@@ -76,6 +133,7 @@ private:
 	// Private Variables For This Class
 	//-------------------------------------------------------------------------
 	CTimer				  m_Timer;			// Game timer
+	CFramePacer				m_FramePacer;		// Paces FrameAdvance, idles while inactive
 	ULONG				   m_LastFrameRate;	// Used for making sure we update only when fps changes.
 	
 	HWND					m_hWnd;			 // Main window HWND
@@ -95,11 +153,44 @@ private:
 	HINSTANCE				m_hInstance;
 
 	CImageFile				m_imgBackground;
+	CKinematics				m_Kinematics;		// Positions / velocities of planes and bullets
+	CFrameArena				m_FrameArena;		// Game thread scratch, reset every FrameAdvance
+	CScriptRuntime			m_Scripts;			// Gameplay sequencing, ticked by AnimateObjects
+	int						m_nBackgroundY;		// Scroll, advanced by BackgroundScript
+	CHud					m_Hud;				// Lives and profiler counters, F9
+	int						m_HudRuns[HUD_COUNT];
+	ULONG					m_nHitTests;		// Collision tests this tick
+	ULONG					m_nHits;			// Of which hit
+	CTelemetry				m_Telemetry;		// Per frame resource log, F6
+	CSoakTest				m_Soak;				// Running when started with -soak
+	CInputLatency			m_Latency;			// Key press to present, F7 writes latency.txt
+	CFrameCapture			m_Capture;			// Frame dump, F8 or -capture
+	bool					m_bHeadless;		// Soak run, the window is never shown
+	CCamera					m_Camera;			// View rect and world bounds
+	CAssetPack				m_Assets;			// data/assets.pak, see tools/AssetPacker
+	CCollisionMask			m_PlaneMasks[FACING_COUNT];
+	CCollisionMask			m_BulletMask;
+	CSpriteAtlas			m_Atlas;			// Packed sprites, see tools/AtlasPacker
+	CTripleBuffer<RenderSnapshot> m_Snapshots;	// Simulation -> renderer handoff
+	ULONG					m_nFrame;			// Simulated frames so far
+	CTileCompositor			m_Compositor;		// Parallel software path for atlas draws
+	bool					m_bSingleThreadedCompose;	// Compare against a one thread composite
+
+	std::thread				m_RenderThread;		// Draws published snapshots when running
+	std::atomic<bool>		m_bRenderQuit;
+	HANDLE					m_hFrameReady;		// Auto reset, set on every Publish
 
 	
 	CPlayer*				m_pPlayer;
 	CPlayer*				m_pPlayer2;
 	CPlayer*                enemy;
+
+	CFlowField				m_FlowField;		// Enemy steering towards the players
+	CAIOpponent				m_AI[2];			// CPU controllers for player 1 / 2
+	bool					m_bAIControl[2];	// Is player 1 / 2 driven by the CPU ?
+	SimInput				m_LastInput[2];		// Input applied last frame, used as the opponent model
+	CAssetLoader			m_Loader;			// Startup load batch, runs on m_ThreadPool
+	CThreadPool				m_ThreadPool;		// Background jobs, declared last so it stops first
 };
 
 #endif // _CGAMEAPP_H_
\ No newline at end of file
@@ -0,0 +1,152 @@
+//-----------------------------------------------------------------------------
+// File: CHud.cpp
+//
+// Desc: In frame text overlay. Glyphs are the font#N regions AtlasPacker
+//	   bakes into the sprite atlas (@font5x7), so HUD text is drawn by the
+//	   same atlas path as the sprites. Text is kept in retained runs; a run
+//	   is only formatted and laid out again when its value changes, drawing
+//	   just copies the laid out glyphs into the queue.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CHud Specific Includes
+//-----------------------------------------------------------------------------
+#include "CHud.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Name : CHud () (Constructor)
+// Desc : CHud Class Constructor
+//-----------------------------------------------------------------------------
+CHud::CHud()
+{
+	m_nGlyphBase	= -1;
+	m_nGlyphWidth	= 0;
+	m_nGlyphHeight	= 0;
+	m_bVisible		= true;
+	m_nLayouts		= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CHud () (Destructor)
+// Desc : CHud Class Destructor
+//-----------------------------------------------------------------------------
+CHud::~CHud()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init ()
+// Desc : Finds the font in the atlas. False when the atlas was packed
+//		without one; runs can still be added but draw nothing.
+//-----------------------------------------------------------------------------
+bool CHud::Init( const CSpriteAtlas& Atlas )
+{
+	m_nGlyphBase = Atlas.IsLoaded() ? Atlas.Find( _T("font#0") ) : -1;
+	if ( m_nGlyphBase < 0 ) return false;
+
+	const RECT& rc	= Atlas.GetRect( m_nGlyphBase );
+	m_nGlyphWidth	= rc.right - rc.left;
+	m_nGlyphHeight	= rc.bottom - rc.top;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddRun ()
+// Desc : Adds a line of text at (x, y). SetValue shows szLabel, the value
+//		with nDecimals and szUnit; SetText replaces the whole line.
+//-----------------------------------------------------------------------------
+int CHud::AddRun( int x, int y, const char* szLabel, int nDecimals, const char* szUnit )
+{
+	m_Runs.push_back( Run() );
+	Run& r = m_Runs.back();
+	r.x			= x;
+	r.y			= y;
+	r.nDecimals	= nDecimals;
+	r.nValue	= 0;
+	r.bHasValue	= false;
+	r.szText[0]	= '\0';
+	strncpy_s( r.szLabel, szLabel, _TRUNCATE );
+	strncpy_s( r.szUnit, szUnit, _TRUNCATE );
+	r.Glyphs.reserve( MAX_TEXT );
+
+	Layout( r, r.szLabel );
+	return (int)m_Runs.size() - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetValue ()
+// Desc : Shows fValue in a run. Nothing happens unless the value changed at
+//		the precision the run displays.
+//-----------------------------------------------------------------------------
+void CHud::SetValue( int nRun, double fValue )
+{
+	Run& r = m_Runs[nRun];
+
+	static const double SCALE[] = { 1.0, 10.0, 100.0, 1000.0 };
+	LONGLONG nValue = (LONGLONG)floor( fValue * SCALE[r.nDecimals & 3] + 0.5 );
+	if ( r.bHasValue && nValue == r.nValue ) return;
+	r.nValue	= nValue;
+	r.bHasValue	= true;
+
+	char szText[MAX_TEXT];
+	sprintf_s( szText, "%s%.*f%s", r.szLabel, r.nDecimals & 3, fValue, r.szUnit );
+	Layout( r, szText );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetText ()
+// Desc : Shows szText in a run, laid out again only if it differs.
+//-----------------------------------------------------------------------------
+void CHud::SetText( int nRun, const char* szText )
+{
+	Run& r = m_Runs[nRun];
+	if ( strncmp( r.szText, szText, MAX_TEXT - 1 ) == 0 ) return;
+
+	r.bHasValue = false;
+	Layout( r, szText );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Queues every laid out glyph on the overlay layer.
+//-----------------------------------------------------------------------------
+void CHud::Draw( CRenderQueue& Queue ) const
+{
+	if ( !m_bVisible || !IsReady() ) return;
+
+	for ( const Run& r : m_Runs )
+		for ( const Glyph& g : r.Glyphs )
+			Queue.AddAtlas( CRenderQueue::LAYER_OVERLAY, g.nRegion, g.x, g.y );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Layout () (Private)
+// Desc : Turns text into glyph regions and positions. Spaces take room but
+//		no command, characters outside the font show as '?'.
+//-----------------------------------------------------------------------------
+void CHud::Layout( Run& r, const char* szText )
+{
+	strncpy_s( r.szText, szText, _TRUNCATE );
+	r.Glyphs.clear();
+	m_nLayouts++;
+
+	if ( !IsReady() ) return;
+
+	int x = r.x + m_nGlyphWidth / 2;
+	int y = r.y + m_nGlyphHeight / 2;
+	for ( const char* p = r.szText; *p; ++p, x += m_nGlyphWidth )
+	{
+		int c = (unsigned char)*p;
+		if ( c == ' ' ) continue;
+		if ( c < FIRST_CHAR || c > LAST_CHAR ) c = '?';
+
+		Glyph g;
+		g.nRegion	= m_nGlyphBase + c - FIRST_CHAR;
+		g.x			= x;
+		g.y			= y;
+		r.Glyphs.push_back( g );
+	}
+}
@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// File: CHud.h
+//
+// Desc: In frame text overlay. Glyphs are the font#N regions AtlasPacker
+//	   bakes into the sprite atlas (@font5x7), so HUD text is drawn by the
+//	   same atlas path as the sprites. Text is kept in retained runs; a run
+//	   is only formatted and laid out again when its value changes, drawing
+//	   just copies the laid out glyphs into the queue.
+//-----------------------------------------------------------------------------
+
+#ifndef _CHUD_H_
+#define _CHUD_H_
+
+//-----------------------------------------------------------------------------
+// CHud Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CSpriteAtlas.h"
+#include "CRenderQueue.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CHud (Class)
+// Desc : Game thread only. Draw emits self contained atlas commands, so the
+//		snapshot can go to the render thread as usual.
+//-----------------------------------------------------------------------------
+class CHud
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		FIRST_CHAR		= 32,		// font#0
+		LAST_CHAR		= 126,
+		MAX_TEXT		= 64,		// Per run, longer text is cut
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CHud();
+	virtual ~CHud();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Init( const CSpriteAtlas& Atlas );
+	bool					IsReady( ) const { return m_nGlyphBase >= 0; }
+	void					SetVisible( bool bVisible ) { m_bVisible = bVisible; }
+	bool					IsVisible( ) const { return m_bVisible; }
+
+	int						AddRun( int x, int y, const char* szLabel, int nDecimals = 0, const char* szUnit = "" );
+	void					SetValue( int nRun, double fValue );
+	void					SetText( int nRun, const char* szText );
+	void					Draw( CRenderQueue& Queue ) const;
+
+	int						GetLineHeight( ) const { return m_nGlyphHeight; }
+	ULONG					GetLayoutCount( ) const { return m_nLayouts; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Glyph
+	{
+		int					nRegion;
+		int					x, y;			// Centre, as AddAtlas wants
+	};
+
+	struct Run
+	{
+		int					x, y;			// Top left of the first glyph
+		char				szLabel[MAX_TEXT];
+		char				szUnit[16];
+		int					nDecimals;
+		LONGLONG			nValue;			// Last value in units of the last decimal
+		bool				bHasValue;
+		char				szText[MAX_TEXT];	// What Glyphs shows
+		std::vector<Glyph>	Glyphs;			// Capacity is kept between layouts
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Layout( Run& r, const char* szText );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	int						m_nGlyphBase;		// Region of font#0, -1 when the atlas has no font
+	int						m_nGlyphWidth;		// Advance, includes the spacing column
+	int						m_nGlyphHeight;
+	bool					m_bVisible;
+	ULONG					m_nLayouts;			// Relayouts since Init, a cost counter
+	std::vector<Run>		m_Runs;
+};
+
+#endif // _CHUD_H_
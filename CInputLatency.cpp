@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+// File: CInputLatency.cpp
+//
+// Desc: Input to photon latency. Each key press is stamped with QPC when the
+//	   window procedure sees it, assigned to the first simulation frame that
+//	   applies it, and completed by the present that first shows that frame
+//	   (whichever thread presents). Distributions are kept per action.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CInputLatency Specific Includes
+//-----------------------------------------------------------------------------
+#include "CInputLatency.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const char* const	ACTION_NAMES[CInputLatency::ACTION_COUNT] = { "move", "shoot", "rotate", "other" };
+}
+
+//-----------------------------------------------------------------------------
+// Name : CInputLatency () (Constructor)
+// Desc : CInputLatency Class Constructor
+//-----------------------------------------------------------------------------
+CInputLatency::CInputLatency()
+{
+	LARGE_INTEGER Frequency;
+	QueryPerformanceFrequency( &Frequency );
+	m_nFrequency = Frequency.QuadPart;
+
+	Reset();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CInputLatency () (Destructor)
+// Desc : CInputLatency Class Destructor
+//-----------------------------------------------------------------------------
+CInputLatency::~CInputLatency()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Forgets every pending input and measurement.
+//-----------------------------------------------------------------------------
+void CInputLatency::Reset()
+{
+	std::lock_guard<std::mutex> Lock( m_Lock );
+
+	m_nPending = 0;
+	memset( m_nSamples, 0, sizeof(m_nSamples) );
+	memset( m_nDropped, 0, sizeof(m_nDropped) );
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnInput ()
+// Desc : Records an input seen at nStamp (QPC, see Now).
+//-----------------------------------------------------------------------------
+void CInputLatency::OnInput( ACTION eAction, LONGLONG nStamp )
+{
+	if ( eAction >= ACTION_COUNT ) return;
+
+	std::lock_guard<std::mutex> Lock( m_Lock );
+
+	if ( m_nPending == MAX_PENDING ) { m_nDropped[eAction]++; return; }
+
+	Pending& p		= m_Pending[m_nPending++];
+	p.eAction		= eAction;
+	p.nInput		= nStamp;
+	p.nSimulated	= 0;
+	p.nFrame		= NO_FRAME;
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnSimulated ()
+// Desc : Call once the frame that applied every input seen so far has been
+//		recorded, before it is handed to the renderer.
+//-----------------------------------------------------------------------------
+void CInputLatency::OnSimulated( ULONG nFrame )
+{
+	LONGLONG nNow = Now();
+
+	std::lock_guard<std::mutex> Lock( m_Lock );
+
+	for ( int i = 0; i < m_nPending; ++i )
+	{
+		if ( m_Pending[i].nFrame != NO_FRAME ) continue;
+		m_Pending[i].nFrame		= nFrame;
+		m_Pending[i].nSimulated	= nNow;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : OnPresented ()
+// Desc : Call right after a frame reached the screen. Completes every input
+//		simulated in that frame or an earlier one, older frames may have
+//		been skipped by the renderer.
+//-----------------------------------------------------------------------------
+void CInputLatency::OnPresented( ULONG nFrame )
+{
+	LONGLONG nNow = Now();
+	double	 fToMs = 1000.0 / m_nFrequency;
+
+	std::lock_guard<std::mutex> Lock( m_Lock );
+
+	int nKept = 0;
+	for ( int i = 0; i < m_nPending; ++i )
+	{
+		const Pending& p = m_Pending[i];
+		if ( p.nFrame == NO_FRAME || p.nFrame > nFrame )
+		{
+			m_Pending[nKept++] = p;
+			continue;
+		}
+
+		ULONG nSlot = m_nSamples[p.eAction]++ % HISTORY;
+		m_History[p.eAction][nSlot]		= (float)( ( nNow - p.nInput ) * fToMs );
+		m_SimHistory[p.eAction][nSlot]	= (float)( ( p.nSimulated - p.nInput ) * fToMs );
+	}
+	m_nPending = nKept;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStats ()
+// Desc : Summarises the recent latencies of one action.
+//-----------------------------------------------------------------------------
+void CInputLatency::GetStats( ACTION eAction, Stats& Out ) const
+{
+	memset( &Out, 0, sizeof(Out) );
+
+	float Sorted[HISTORY];
+	double fSum = 0, fSimSum = 0;
+	ULONG nCount;
+	{
+		std::lock_guard<std::mutex> Lock( m_Lock );
+
+		Out.nCount		= m_nSamples[eAction];
+		Out.nDropped	= m_nDropped[eAction];
+		nCount			= std::min<ULONG>( m_nSamples[eAction], HISTORY );
+		for ( ULONG i = 0; i < nCount; ++i )
+		{
+			Sorted[i] = m_History[eAction][i];
+			fSum	 += m_History[eAction][i];
+			fSimSum	 += m_SimHistory[eAction][i];
+		}
+	}
+	if ( nCount == 0 ) return;
+
+	std::sort( Sorted, Sorted + nCount );
+	Out.fMeanMs	= fSum / nCount;
+	Out.fSimMs	= fSimSum / nCount;
+	Out.fP50Ms	= Sorted[ nCount / 2 ];
+	Out.fP95Ms	= Sorted[ std::min<ULONG>( nCount - 1, nCount * 95 / 100 ) ];
+	Out.fP99Ms	= Sorted[ std::min<ULONG>( nCount - 1, nCount * 99 / 100 ) ];
+	Out.fMaxMs	= Sorted[ nCount - 1 ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteReport ()
+// Desc : Writes a table of every action's distribution to szPath and the
+//		debugger output.
+//-----------------------------------------------------------------------------
+bool CInputLatency::WriteReport( const char* szPath ) const
+{
+	FILE* pFile = NULL;
+	if ( fopen_s( &pFile, szPath, "w" ) != 0 ) return false;
+
+	char szLine[256];
+	sprintf_s( szLine, "%-8s %7s %7s %8s %8s %8s %8s %8s %8s\n", "action", "count", "dropped", "mean", "p50", "p95", "p99", "max", "sim" );
+	fputs( szLine, pFile );
+	OutputDebugStringA( szLine );
+
+	for ( int i = 0; i < ACTION_COUNT; ++i )
+	{
+		Stats s;
+		GetStats( (ACTION)i, s );
+		sprintf_s( szLine, "%-8s %7lu %7lu %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n", ACTION_NAMES[i], s.nCount, s.nDropped,
+				   s.fMeanMs, s.fP50Ms, s.fP95Ms, s.fP99Ms, s.fMaxMs, s.fSimMs );
+		fputs( szLine, pFile );
+		OutputDebugStringA( szLine );
+	}
+
+	fclose( pFile );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Now ()
+// Desc : Current QPC time, the clock every stamp must use.
+//-----------------------------------------------------------------------------
+LONGLONG CInputLatency::Now() const
+{
+	LARGE_INTEGER Counter;
+	QueryPerformanceCounter( &Counter );
+	return Counter.QuadPart;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ActionForKey () (Static)
+// Desc : Which action a key press measures, ACTION_COUNT for keys that
+//		change nothing on screen.
+//-----------------------------------------------------------------------------
+CInputLatency::ACTION CInputLatency::ActionForKey( WPARAM nKey )
+{
+	switch ( nKey )
+	{
+	case VK_UP: case VK_DOWN: case VK_LEFT: case VK_RIGHT:
+	case 'W': case 'A': case 'S': case 'D':
+		return ACTION_MOVE;
+	case VK_SPACE: case 'H':
+		return ACTION_SHOOT;
+	case 'O': case 'R':
+		return ACTION_ROTATE;
+	case VK_RETURN: case 'Q':
+		return ACTION_OTHER;
+	default:
+		return ACTION_COUNT;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetName () (Static)
+// Desc : Short name used in reports.
+//-----------------------------------------------------------------------------
+const char* CInputLatency::GetName( ACTION eAction )
+{
+	return ACTION_NAMES[eAction];
+}
@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+// File: CInputLatency.h
+//
+// Desc: Input to photon latency. Each key press is stamped with QPC when the
+//	   window procedure sees it, assigned to the first simulation frame that
+//	   applies it, and completed by the present that first shows that frame
+//	   (whichever thread presents). Distributions are kept per action.
+//-----------------------------------------------------------------------------
+
+#ifndef _CINPUTLATENCY_H_
+#define _CINPUTLATENCY_H_
+
+//-----------------------------------------------------------------------------
+// CInputLatency Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CInputLatency (Class)
+// Desc : OnInput / OnSimulated come from the game thread, OnPresented from
+//		the render thread when it runs; one lock covers all three, they are
+//		called a handful of times per frame. Fixed storage, no allocation.
+//-----------------------------------------------------------------------------
+class CInputLatency
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum ACTION
+	{
+		ACTION_MOVE,				// Arrows / WASD, applied by ProcessInput
+		ACTION_SHOOT,				// Applied right in DisplayWndProc
+		ACTION_ROTATE,
+		ACTION_OTHER,				// Debug explode keys
+		ACTION_COUNT
+	};
+
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		MAX_PENDING		= 64,		// Inputs not yet presented
+		HISTORY			= 512,		// Latencies kept per action
+		NO_FRAME		= 0,		// Frame numbers start at 1
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Stats
+	{
+		ULONG		nCount;			// Inputs measured in total
+		ULONG		nDropped;		// Lost because too many were pending
+		double		fMeanMs;		// Input to present
+		double		fP50Ms;
+		double		fP95Ms;
+		double		fP99Ms;
+		double		fMaxMs;
+		double		fSimMs;			// Mean part spent before the frame was recorded
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CInputLatency();
+	virtual ~CInputLatency();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					OnInput( ACTION eAction, LONGLONG nStamp );
+	void					OnSimulated( ULONG nFrame );
+	void					OnPresented( ULONG nFrame );
+	void					GetStats( ACTION eAction, Stats& Out ) const;
+	bool					WriteReport( const char* szPath ) const;
+	void					Reset( );
+
+	LONGLONG				Now( ) const;
+	static ACTION			ActionForKey( WPARAM nKey );
+	static const char*		GetName( ACTION eAction );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Pending
+	{
+		ACTION		eAction;
+		LONGLONG	nInput;			// When the key was seen
+		LONGLONG	nSimulated;		// When its frame was recorded
+		ULONG		nFrame;			// NO_FRAME until simulated
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	mutable std::mutex		m_Lock;
+	LONGLONG				m_nFrequency;
+	Pending					m_Pending[MAX_PENDING];
+	int						m_nPending;
+	float					m_History[ACTION_COUNT][HISTORY];	// Total ms, ring
+	float					m_SimHistory[ACTION_COUNT][HISTORY];
+	ULONG					m_nSamples[ACTION_COUNT];
+	ULONG					m_nDropped[ACTION_COUNT];
+};
+
+#endif // _CINPUTLATENCY_H_
@@ -0,0 +1,274 @@
+//-----------------------------------------------------------------------------
+// File: CKinematics.cpp
+//
+// Desc: Structure of arrays store for everything that moves (planes and
+//	   bullets). One Integrate call advances position, velocity and
+//	   acceleration for all bodies, four at a time with SSE, with optional
+//	   per body damping and bounds clamping.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CKinematics Specific Includes
+//-----------------------------------------------------------------------------
+#include "CKinematics.h"
+#include <cfloat>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 )
+	#define KINEMATICS_SSE
+	#include <xmmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : CKinematics () (Constructor)
+// Desc : CKinematics Class Constructor
+//-----------------------------------------------------------------------------
+CKinematics::CKinematics()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CKinematics () (Destructor)
+// Desc : CKinematics Class Destructor
+//-----------------------------------------------------------------------------
+CKinematics::~CKinematics()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Adds an unbounded, undamped body and returns its handle.
+//-----------------------------------------------------------------------------
+int CKinematics::Create( const Vec2& Position, const Vec2& Velocity )
+{
+	std::lock_guard<std::mutex> Lock( m_CreateLock );
+
+	int nBody;
+	if ( !m_FreeHandles.empty() )
+	{
+		nBody = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+	}
+	else
+	{
+		nBody = (int)m_Slot.size();
+		m_Slot.push_back( INVALID_BODY );
+	}
+
+	m_Slot[nBody] = (int)m_X.size();
+	m_Owner.push_back( nBody );
+	m_X.push_back( (float)Position.x );
+	m_Y.push_back( (float)Position.y );
+	m_VX.push_back( (float)Velocity.x );
+	m_VY.push_back( (float)Velocity.y );
+	m_AX.push_back( 0.0f );
+	m_AY.push_back( 0.0f );
+	m_Damping.push_back( 0.0f );
+	m_MinX.push_back( -FLT_MAX );
+	m_MinY.push_back( -FLT_MAX );
+	m_MaxX.push_back( FLT_MAX );
+	m_MaxY.push_back( FLT_MAX );
+
+	return nBody;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Destroy ()
+// Desc : Frees a body, moving the last one into its slot.
+//-----------------------------------------------------------------------------
+void CKinematics::Destroy( int nBody )
+{
+	std::lock_guard<std::mutex> Lock( m_CreateLock );
+
+	if ( nBody < 0 || nBody >= (int)m_Slot.size() || m_Slot[nBody] == INVALID_BODY ) return;
+
+	int i	 = m_Slot[nBody];
+	int Last = (int)m_X.size() - 1;
+
+	m_X[i]		 = m_X[Last];		m_Y[i]		 = m_Y[Last];
+	m_VX[i]		 = m_VX[Last];		m_VY[i]		 = m_VY[Last];
+	m_AX[i]		 = m_AX[Last];		m_AY[i]		 = m_AY[Last];
+	m_Damping[i] = m_Damping[Last];
+	m_MinX[i]	 = m_MinX[Last];	m_MinY[i]	 = m_MinY[Last];
+	m_MaxX[i]	 = m_MaxX[Last];	m_MaxY[i]	 = m_MaxY[Last];
+	m_Owner[i]	 = m_Owner[Last];
+	m_Slot[m_Owner[i]] = i;
+
+	m_X.pop_back();		m_Y.pop_back();
+	m_VX.pop_back();	m_VY.pop_back();
+	m_AX.pop_back();	m_AY.pop_back();
+	m_Damping.pop_back();
+	m_MinX.pop_back();	m_MinY.pop_back();
+	m_MaxX.pop_back();	m_MaxY.pop_back();
+	m_Owner.pop_back();
+
+	m_Slot[nBody] = INVALID_BODY;
+	m_FreeHandles.push_back( nBody );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Destroys every body, capacity is kept.
+//-----------------------------------------------------------------------------
+void CKinematics::Clear()
+{
+	std::lock_guard<std::mutex> Lock( m_CreateLock );
+
+	m_X.clear();	m_Y.clear();
+	m_VX.clear();	m_VY.clear();
+	m_AX.clear();	m_AY.clear();
+	m_Damping.clear();
+	m_MinX.clear();	m_MinY.clear();
+	m_MaxX.clear();	m_MaxY.clear();
+	m_Owner.clear();
+	m_Slot.clear();
+	m_FreeHandles.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reserve ()
+// Desc : Pre-sizes the arrays so Create does not reallocate mid game.
+//-----------------------------------------------------------------------------
+void CKinematics::Reserve( int nBodies )
+{
+	std::lock_guard<std::mutex> Lock( m_CreateLock );
+
+	m_X.reserve( nBodies );		m_Y.reserve( nBodies );
+	m_VX.reserve( nBodies );	m_VY.reserve( nBodies );
+	m_AX.reserve( nBodies );	m_AY.reserve( nBodies );
+	m_Damping.reserve( nBodies );
+	m_MinX.reserve( nBodies );	m_MinY.reserve( nBodies );
+	m_MaxX.reserve( nBodies );	m_MaxY.reserve( nBodies );
+	m_Owner.reserve( nBodies );
+	m_Slot.reserve( nBodies );
+	m_FreeHandles.reserve( nBodies );
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPosition () / GetVelocity ()
+// Desc : Body state accessors.
+//-----------------------------------------------------------------------------
+Vec2 CKinematics::GetPosition( int nBody ) const
+{
+	int i = m_Slot[nBody];
+	return Vec2( m_X[i], m_Y[i] );
+}
+
+Vec2 CKinematics::GetVelocity( int nBody ) const
+{
+	int i = m_Slot[nBody];
+	return Vec2( m_VX[i], m_VY[i] );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetPosition () / SetVelocity () / SetAcceleration ()
+// Desc : Body state mutators.
+//-----------------------------------------------------------------------------
+void CKinematics::SetPosition( int nBody, const Vec2& Position )
+{
+	int i = m_Slot[nBody];
+	m_X[i] = (float)Position.x;
+	m_Y[i] = (float)Position.y;
+}
+
+void CKinematics::SetVelocity( int nBody, const Vec2& Velocity )
+{
+	int i = m_Slot[nBody];
+	m_VX[i] = (float)Velocity.x;
+	m_VY[i] = (float)Velocity.y;
+}
+
+void CKinematics::SetAcceleration( int nBody, const Vec2& Acceleration )
+{
+	int i = m_Slot[nBody];
+	m_AX[i] = (float)Acceleration.x;
+	m_AY[i] = (float)Acceleration.y;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetDamping ()
+// Desc : Fraction of the velocity lost per second, 0 for none.
+//-----------------------------------------------------------------------------
+void CKinematics::SetDamping( int nBody, float fPerSecond )
+{
+	m_Damping[m_Slot[nBody]] = fPerSecond;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetBounds () / ClearBounds ()
+// Desc : Box the body's centre is clamped to. Hitting a side stops the
+//		velocity along that axis.
+//-----------------------------------------------------------------------------
+void CKinematics::SetBounds( int nBody, const Bounds& Clamp )
+{
+	int i = m_Slot[nBody];
+	m_MinX[i] = Clamp.fMinX;
+	m_MinY[i] = Clamp.fMinY;
+	m_MaxX[i] = Clamp.fMaxX;
+	m_MaxY[i] = Clamp.fMaxY;
+}
+
+void CKinematics::ClearBounds( int nBody )
+{
+	int i = m_Slot[nBody];
+	m_MinX[i] = m_MinY[i] = -FLT_MAX;
+	m_MaxX[i] = m_MaxY[i] = FLT_MAX;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Integrate ()
+// Desc : Semi-implicit Euler step for every body:
+//			v = (v + a dt) * max(0, 1 - damping dt),  p = clamp(p + v dt)
+//		with the velocity zeroed on any axis that was clamped.
+//-----------------------------------------------------------------------------
+void CKinematics::Integrate( float dt )
+{
+	int nCount = (int)m_X.size();
+	int i = 0;
+
+#ifdef KINEMATICS_SSE
+	const __m128 Dt	  = _mm_set1_ps( dt );
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One  = _mm_set1_ps( 1.0f );
+
+	for ( ; i + 4 <= nCount; i += 4 )
+	{
+		__m128 Keep = _mm_max_ps( Zero, _mm_sub_ps( One, _mm_mul_ps( _mm_loadu_ps( &m_Damping[i] ), Dt ) ) );
+
+		__m128 vx = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( &m_VX[i] ), _mm_mul_ps( _mm_loadu_ps( &m_AX[i] ), Dt ) ), Keep );
+		__m128 vy = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( &m_VY[i] ), _mm_mul_ps( _mm_loadu_ps( &m_AY[i] ), Dt ) ), Keep );
+
+		__m128 px = _mm_add_ps( _mm_loadu_ps( &m_X[i] ), _mm_mul_ps( vx, Dt ) );
+		__m128 py = _mm_add_ps( _mm_loadu_ps( &m_Y[i] ), _mm_mul_ps( vy, Dt ) );
+
+		__m128 cx = _mm_min_ps( _mm_max_ps( px, _mm_loadu_ps( &m_MinX[i] ) ), _mm_loadu_ps( &m_MaxX[i] ) );
+		__m128 cy = _mm_min_ps( _mm_max_ps( py, _mm_loadu_ps( &m_MinY[i] ) ), _mm_loadu_ps( &m_MaxY[i] ) );
+
+		// Keep the velocity only on axes that were not clamped
+		vx = _mm_and_ps( vx, _mm_cmpeq_ps( cx, px ) );
+		vy = _mm_and_ps( vy, _mm_cmpeq_ps( cy, py ) );
+
+		_mm_storeu_ps( &m_X[i], cx );
+		_mm_storeu_ps( &m_Y[i], cy );
+		_mm_storeu_ps( &m_VX[i], vx );
+		_mm_storeu_ps( &m_VY[i], vy );
+	}
+#endif
+
+	for ( ; i < nCount; ++i )
+	{
+		float fKeep = std::max( 0.0f, 1.0f - m_Damping[i] * dt );
+
+		float vx = ( m_VX[i] + m_AX[i] * dt ) * fKeep;
+		float vy = ( m_VY[i] + m_AY[i] * dt ) * fKeep;
+		float px = m_X[i] + vx * dt;
+		float py = m_Y[i] + vy * dt;
+		float cx = std::min( std::max( px, m_MinX[i] ), m_MaxX[i] );
+		float cy = std::min( std::max( py, m_MinY[i] ), m_MaxY[i] );
+
+		m_X[i]	= cx;
+		m_Y[i]	= cy;
+		m_VX[i]	= ( cx == px ) ? vx : 0.0f;
+		m_VY[i]	= ( cy == py ) ? vy : 0.0f;
+	}
+}
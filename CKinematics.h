@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// File: CKinematics.h
+//
+// Desc: Structure of arrays store for everything that moves (planes and
+//	   bullets). One Integrate call advances position, velocity and
+//	   acceleration for all bodies, four at a time with SSE, with optional
+//	   per body damping and bounds clamping.
+//-----------------------------------------------------------------------------
+
+#ifndef _CKINEMATICS_H_
+#define _CKINEMATICS_H_
+
+//-----------------------------------------------------------------------------
+// CKinematics Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <vector>
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CKinematics (Class)
+// Desc : Bodies are addressed by handles that stay valid until Destroy; the
+//		arrays themselves stay dense (destroy swaps the last body in) so
+//		Integrate never skips holes. Create / Destroy may be called from
+//		several threads (e.g. loader jobs), everything else only from the
+//		game thread.
+//-----------------------------------------------------------------------------
+class CKinematics
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum { INVALID_BODY = -1 };
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Bounds
+	{
+		float			fMinX, fMinY;
+		float			fMaxX, fMaxY;
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CKinematics();
+	virtual ~CKinematics();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	int						Create( const Vec2& Position, const Vec2& Velocity );
+	void					Destroy( int nBody );
+	void					Clear( );
+	void					Reserve( int nBodies );
+
+	Vec2					GetPosition( int nBody ) const;
+	Vec2					GetVelocity( int nBody ) const;
+	void					SetPosition( int nBody, const Vec2& Position );
+	void					SetVelocity( int nBody, const Vec2& Velocity );
+	void					SetAcceleration( int nBody, const Vec2& Acceleration );
+	void					SetDamping( int nBody, float fPerSecond );
+	void					SetBounds( int nBody, const Bounds& Clamp );
+	void					ClearBounds( int nBody );
+
+	void					Integrate( float dt );
+	int						GetCount( ) const { return (int)m_X.size(); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	// Dense, one entry per live body
+	std::vector<float>		m_X, m_Y;
+	std::vector<float>		m_VX, m_VY;
+	std::vector<float>		m_AX, m_AY;
+	std::vector<float>		m_Damping;			// Fraction of velocity lost per second
+	std::vector<float>		m_MinX, m_MinY;		// Clamp box, +-FLT_MAX when unbounded
+	std::vector<float>		m_MaxX, m_MaxY;
+	std::vector<int>		m_Owner;			// Dense index -> handle
+
+	std::vector<int>		m_Slot;				// Handle -> dense index, -1 if free
+	std::vector<int>		m_FreeHandles;
+	std::mutex				m_CreateLock;
+};
+
+#endif // _CKINEMATICS_H_
@@ -0,0 +1,152 @@
+//-----------------------------------------------------------------------------
+// File: CLZ4Block.cpp
+//
+// Desc: Minimal LZ4 block format codec used by the asset pack. Greedy single
+//	   hash table compressor (offline, in tools/AssetPacker) and a bounds
+//	   checked decoder (runtime). Platform independent.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CLZ4Block Specific Includes
+//-----------------------------------------------------------------------------
+#include "CLZ4Block.h"
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const size_t	MIN_MATCH		= 4;
+	const size_t	LAST_LITERALS	= 5;		// Block must end with this many literals
+	const size_t	MF_LIMIT		= 12;		// No match may start in the last 12 bytes
+	const size_t	MAX_OFFSET		= 65535;
+	const int		HASH_BITS		= 16;
+
+	inline unsigned int Read32( const unsigned char* p )
+	{
+		unsigned int v;
+		memcpy( &v, p, 4 );
+		return v;
+	}
+
+	inline unsigned int Hash( unsigned int v )
+	{
+		return ( v * 2654435761u ) >> ( 32 - HASH_BITS );
+	}
+
+	// Writes a length that did not fit in its 4 bit token nibble
+	inline void WriteLength( std::vector<unsigned char>& Out, size_t nLength )
+	{
+		for ( ; nLength >= 255; nLength -= 255 ) Out.push_back( 255 );
+		Out.push_back( (unsigned char)nLength );
+	}
+
+	inline void WriteSequence( std::vector<unsigned char>& Out, const unsigned char* pLiterals, size_t nLiterals, size_t nOffset, size_t nMatch )
+	{
+		size_t nMatchCode = ( nMatch >= MIN_MATCH ) ? nMatch - MIN_MATCH : 0;
+		unsigned char Token = (unsigned char)( ( ( nLiterals < 15 ? nLiterals : 15 ) << 4 ) | ( nMatchCode < 15 ? nMatchCode : 15 ) );
+
+		Out.push_back( Token );
+		if ( nLiterals >= 15 ) WriteLength( Out, nLiterals - 15 );
+		Out.insert( Out.end(), pLiterals, pLiterals + nLiterals );
+
+		if ( nMatch == 0 ) return;
+		Out.push_back( (unsigned char)( nOffset & 0xFF ) );
+		Out.push_back( (unsigned char)( nOffset >> 8 ) );
+		if ( nMatchCode >= 15 ) WriteLength( Out, nMatchCode - 15 );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Compress () (Static)
+// Desc : Greedy LZ4 block compression of pSrc into Out (replaced).
+//-----------------------------------------------------------------------------
+void CLZ4Block::Compress( const unsigned char* pSrc, size_t nSrcSize, std::vector<unsigned char>& Out )
+{
+	Out.clear();
+	Out.reserve( nSrcSize + nSrcSize / 255 + 16 );
+
+	size_t nAnchor = 0;
+	if ( nSrcSize >= MF_LIMIT + 1 )
+	{
+		std::vector<size_t> Table( (size_t)1 << HASH_BITS, (size_t)-1 );
+		size_t nMatchLimit = nSrcSize - MF_LIMIT;
+
+		for ( size_t i = 0; i < nMatchLimit; )
+		{
+			unsigned int	nSeq	= Read32( pSrc + i );
+			unsigned int	h		= Hash( nSeq );
+			size_t			nCand	= Table[h];
+			Table[h] = i;
+
+			if ( nCand == (size_t)-1 || i - nCand > MAX_OFFSET || Read32( pSrc + nCand ) != nSeq ) { ++i; continue; }
+
+			// Extend the match, stopping short of the mandatory literal tail
+			size_t nLength = MIN_MATCH;
+			size_t nEnd    = nSrcSize - LAST_LITERALS;
+			while ( i + nLength < nEnd && pSrc[ nCand + nLength ] == pSrc[ i + nLength ] ) ++nLength;
+
+			WriteSequence( Out, pSrc + nAnchor, i - nAnchor, i - nCand, nLength );
+			i      += nLength;
+			nAnchor = i;
+		}
+	}
+
+	// Trailing literals
+	WriteSequence( Out, pSrc + nAnchor, nSrcSize - nAnchor, 0, 0 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Decompress () (Static)
+// Desc : Decodes a block into exactly nDstSize bytes. Returns false on any
+//		malformed input instead of reading or writing out of bounds.
+//-----------------------------------------------------------------------------
+bool CLZ4Block::Decompress( const unsigned char* pSrc, size_t nSrcSize, unsigned char* pDst, size_t nDstSize )
+{
+	const unsigned char* pIn	= pSrc;
+	const unsigned char* pInEnd	= pSrc + nSrcSize;
+	unsigned char*		 pOut	= pDst;
+	unsigned char*		 pOutEnd= pDst + nDstSize;
+
+	while ( pIn < pInEnd )
+	{
+		unsigned char Token = *pIn++;
+
+		// Literals
+		size_t nLiterals = Token >> 4;
+		if ( nLiterals == 15 )
+		{
+			unsigned char b;
+			do { if ( pIn >= pInEnd ) return false; b = *pIn++; nLiterals += b; } while ( b == 255 );
+		}
+		if ( (size_t)( pInEnd - pIn ) < nLiterals || (size_t)( pOutEnd - pOut ) < nLiterals ) return false;
+		memcpy( pOut, pIn, nLiterals );
+		pIn  += nLiterals;
+		pOut += nLiterals;
+
+		// The last sequence has no match part
+		if ( pIn == pInEnd ) break;
+
+		if ( pInEnd - pIn < 2 ) return false;
+		size_t nOffset = pIn[0] | ( pIn[1] << 8 );
+		pIn += 2;
+		if ( nOffset == 0 || nOffset > (size_t)( pOut - pDst ) ) return false;
+
+		size_t nMatch = Token & 0x0F;
+		if ( nMatch == 15 )
+		{
+			unsigned char b;
+			do { if ( pIn >= pInEnd ) return false; b = *pIn++; nMatch += b; } while ( b == 255 );
+		}
+		nMatch += MIN_MATCH;
+		if ( (size_t)( pOutEnd - pOut ) < nMatch ) return false;
+
+		// Byte copy, matches may overlap their own output
+		const unsigned char* pMatch = pOut - nOffset;
+		for ( size_t i = 0; i < nMatch; ++i ) pOut[i] = pMatch[i];
+		pOut += nMatch;
+	}
+
+	return pOut == pOutEnd;
+}
@@ -0,0 +1,35 @@
+//-----------------------------------------------------------------------------
+// File: CLZ4Block.h
+//
+// Desc: Minimal LZ4 block format codec used by the asset pack. Greedy single
+//	   hash table compressor (offline, in tools/AssetPacker) and a bounds
+//	   checked decoder (runtime). Platform independent.
+//-----------------------------------------------------------------------------
+
+#ifndef _CLZ4BLOCK_H_
+#define _CLZ4BLOCK_H_
+
+//-----------------------------------------------------------------------------
+// CLZ4Block Specific Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CLZ4Block (Class)
+// Desc : Stateless LZ4 block compress / decompress.
+//-----------------------------------------------------------------------------
+class CLZ4Block
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class.
+	//-------------------------------------------------------------------------
+	static void				Compress( const unsigned char* pSrc, size_t nSrcSize, std::vector<unsigned char>& Out );
+	static bool				Decompress( const unsigned char* pSrc, size_t nSrcSize, unsigned char* pDst, size_t nDstSize );
+};
+
+#endif // _CLZ4BLOCK_H_
@@ -11,33 +11,51 @@
 // CPlayer Specific Includes
 //-----------------------------------------------------------------------------
 #include "CPlayer.h"
-#include <list>
 #include "CGameApp.h"
+#include "CSweptCollision.h"
+#include <cmath>
 
 extern CGameApp g_App;
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	// One explosion frame per this many ticks, about 70 ms at 60 fps
+	const ULONG			EXPLOSION_TICKS		= 4;
+}
+
 //-----------------------------------------------------------------------------
 // Name : CPlayer () (Constructor)
-// Desc : CPlayer Class Constructor
+// Desc : CPlayer Class Constructor. Kind picks the ENTITY_TYPES row the
+//		plane's facing, aim and weapon come from.
 //-----------------------------------------------------------------------------
-CPlayer::CPlayer(const BackBuffer *pBackBuffer,int x) : rotateDirection(DIRECTION::DIR_FORWARD),playerLives(3)
+CPlayer::CPlayer(const BackBuffer *pBackBuffer, ENTITY_KIND Kind) : playerLives(3)
 {
+	m_pType		= &ENTITY_TYPES[Kind];
+	m_pWeapon	= &WEAPON_TYPES[m_pType->eWeapon];
 
 	//m_pSprite = new Sprite("data/planeimg.bmp", "data/planemask.bmp");
-	if (x == 1) {
-		m_pSprite = new Sprite("data/planeimgandmask.bmp", RGB(0xff, 0x00, 0xff));
-		m_pSprite->setBackBuffer(pBackBuffer);
-	}else{
-		m_pSprite = new Sprite("data/planeimgandmaskk.bmp", RGB(0xff, 0x00, 0xff));
-		m_pSprite->setBackBuffer(pBackBuffer);
+	// Every facing is loaded up front, rotating only switches between them
+	for (int i = 0; i < FACING_COUNT; ++i) {
+		m_pPlaneSprites[i] = new Sprite(FACING_TYPES[i].szBitmap, RGB(0xff, 0x00, 0xff));
+		m_pPlaneSprites[i]->setBackBuffer(pBackBuffer);
+		m_nPlaneRegions[i] = g_App.GetAtlas().Find(FACING_TYPES[i].szRegion);
 	}
-	
-	
+
+	SetFacing(m_pType->eStartFacing);
 
 	m_eSpeedState = SPEED_STOP;
 	m_fTimer = 0;
+	m_bReloading = false;
+	fireCooldown = m_pWeapon->nFirstShotTicks;
+	m_nBody = g_App.GetKinematics().Create(Vec2(0, 0), Vec2(0, 0));
+	bullets.reserve(32);
 
-	bullet = new Sprite("data/b.bmp", "data/bm.bmp");
+	bullet = new Sprite(m_pWeapon->szBitmap, m_pWeapon->szMask);
 	bullet->setBackBuffer(pBackBuffer);
+	m_nBulletRegion = g_App.GetAtlas().Find(m_pWeapon->szRegion);
 
 	// Animation frame crop rectangle
 	RECT r;
@@ -50,6 +68,7 @@ CPlayer::CPlayer(const BackBuffer *pBackBuffer,int x) : rotateDirection(DIRECTIO
 	m_pExplosionSprite->setBackBuffer( pBackBuffer );
 	m_bExplosion		= false;
 	m_iExplosionFrame	= 0;
+	m_nExplosionRegion	= g_App.GetAtlas().Find("explosion#0");
 
 
 
@@ -62,18 +81,31 @@ CPlayer::CPlayer(const BackBuffer *pBackBuffer,int x) : rotateDirection(DIRECTIO
 //-----------------------------------------------------------------------------
 CPlayer::~CPlayer()
 {
-	delete m_pSprite;
+	CKinematics& Kinematics = g_App.GetKinematics();
+	for (int nBody : bullets)
+		Kinematics.Destroy(nBody);
+	Kinematics.Destroy(m_nBody);
+
+	delete bullet;
+	for (Sprite* pSprite : m_pPlaneSprites)
+		delete pSprite;
 	delete m_pExplosionSprite;
 }
 
 void CPlayer::Update(float dt)
 {
-	// Update sprite
-	m_pSprite->update(dt);
-
+	// Movement itself is integrated for every body at once in CKinematics,
+	// here we only keep the plane's clamp box in step with the world
+	const RECT& rcWorld = g_App.GetCamera().GetWorldBounds();
+	CKinematics::Bounds Clamp;
+	Clamp.fMinX = (float)(rcWorld.left + m_pSprite->width() / 2);
+	Clamp.fMaxX = (float)(rcWorld.right - m_pSprite->width() / 2);
+	Clamp.fMinY = (float)(rcWorld.top + m_pSprite->height() / 2);
+	Clamp.fMaxY = (float)(rcWorld.bottom - m_pSprite->height() / 2);
+	g_App.GetKinematics().SetBounds(m_nBody, Clamp);
 
 	// Get velocity
-	double v = m_pSprite->mVelocity.Magnitude();
+	double v = Velocity().Magnitude();
 
 
 	// NOTE: for each async sound played Windows creates a thread for you
@@ -91,7 +123,7 @@ void CPlayer::Update(float dt)
 		if(v > 35.0f)
 		{
 			m_eSpeedState = SPEED_START;
-			PlaySound("data/jet-start.wav", NULL, SND_FILENAME | SND_ASYNC);
+			g_App.GetAssets().PlaySoundAsset("data/jet-start.wav");
 			m_fTimer = 0;
 		}
 		break;
@@ -99,13 +131,13 @@ void CPlayer::Update(float dt)
 		if(v < 25.0f)
 		{
 			m_eSpeedState = SPEED_STOP;
-			PlaySound("data/jet-stop.wav", NULL, SND_FILENAME | SND_ASYNC);
+			g_App.GetAssets().PlaySoundAsset("data/jet-stop.wav");
 			m_fTimer = 0;
 		}
 		else
 			if(m_fTimer > 1.f)
 			{
-				PlaySound("data/jet-cabin.wav", NULL, SND_FILENAME | SND_ASYNC);
+				g_App.GetAssets().PlaySoundAsset("data/jet-cabin.wav");
 				m_fTimer = 0;
 			}
 		break;
@@ -117,74 +149,116 @@ void CPlayer::Update(float dt)
 	// http://www.codeproject.com/KB/audio-video/midiwrapper.aspx (with code also)
 }
 
-void CPlayer::Draw()
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Emits the plane (or its explosion) into the frame's render queue.
+//-----------------------------------------------------------------------------
+void CPlayer::Draw(CRenderQueue& Queue)
 {
-	if (fireCooldown > 1) {
-		fireCooldown--;
-	}
 	if (!m_bExplosion) {
-		m_pSprite->draw();
+		DrawSprite(Queue, CRenderQueue::LAYER_PLANES, m_pSprite, m_nSpriteRegion, Position());
+	}
+	else {
+		// The frame on screen is the one AdvanceExplosion selected last
+		int nFrame = (m_iExplosionFrame > 0) ? m_iExplosionFrame - 1 : 0;
+		DrawSprite(Queue, CRenderQueue::LAYER_PLANES, m_pExplosionSprite, (m_nExplosionRegion >= 0) ? m_nExplosionRegion + nFrame : -1, m_pExplosionSprite->mPosition);
 	}
-	else
-		m_pExplosionSprite->draw();
 }
 
+//-----------------------------------------------------------------------------
+// Name : DrawBullets ()
+// Desc : Emits every live bullet into the frame's render queue.
+//-----------------------------------------------------------------------------
+void CPlayer::DrawBullets(CRenderQueue& Queue)
+{
+	const CKinematics& Kinematics = g_App.GetKinematics();
+	for (int nBody : bullets)
+		DrawSprite(Queue, CRenderQueue::LAYER_BULLETS, bullet, m_nBulletRegion, Kinematics.GetPosition(nBody));
+}
 
-void CPlayer::Move(ULONG ulDirection)
+//-----------------------------------------------------------------------------
+// Name : HasAtlasRegions ()
+// Desc : True when every facing, the bullet and the explosion were found in
+//		the atlas, so Draw and DrawBullets never fall back to a Sprite.
+//-----------------------------------------------------------------------------
+bool CPlayer::HasAtlasRegions() const
 {
-	
-	if (m_pSprite->mPosition.x < m_pSprite->width()-m_pSprite->mPosition.x) {
-		m_pSprite->mPosition.x = m_pSprite->width() - m_pSprite->mPosition.x;
-		m_pSprite->mVelocity.x = 0;
-	}
+	if (!g_App.GetAtlas().IsLoaded() || m_nBulletRegion < 0 || m_nExplosionRegion < 0)
+		return false;
 
-	if (m_pSprite->mPosition.x >  GetSystemMetrics(SM_CXSCREEN) - m_pSprite->width()/2) {
-		m_pSprite->mPosition.x = GetSystemMetrics(SM_CXSCREEN) - m_pSprite->width()/2;
-		m_pSprite->mVelocity.x = 0;
-	}
+	for (int nRegion : m_nPlaneRegions)
+		if (nRegion < 0) return false;
+	return true;
+}
 
-	if (m_pSprite->mPosition.y < m_pSprite->height() - m_pSprite->mPosition.y) {
-		m_pSprite->mPosition.y = m_pSprite->height() - m_pSprite->mPosition.y;
-		m_pSprite->mVelocity.y = 0;
-	}
+//-----------------------------------------------------------------------------
+// Name : DrawSprite () (Private)
+// Desc : Culls against the view, then queues the sprite's atlas region, or
+//		the sprite's own bitmap when it has none, centred on Position.
+//-----------------------------------------------------------------------------
+void CPlayer::DrawSprite(CRenderQueue& Queue, CRenderQueue::LAYER Layer, Sprite* pSprite, int nRegion, const Vec2& Position)
+{
+	if (!g_App.GetCamera().IsVisible(Position, pSprite->width(), pSprite->height()))
+		return;
 
-	if (m_pSprite->mPosition.y > GetSystemMetrics(SM_CYSCREEN) - m_pSprite->height()) {
-		m_pSprite->mPosition.y = GetSystemMetrics(SM_CYSCREEN) - m_pSprite->height();
-		m_pSprite->mVelocity.y = 0;
-	}
+	int x = (int)Position.x;
+	int y = (int)Position.y;
+
+	if (g_App.GetAtlas().IsLoaded() && nRegion >= 0)
+		Queue.AddAtlas(Layer, nRegion, x, y);
+	else
+		Queue.AddSprite(Layer, pSprite, x, y);
+}
+
+
+//-----------------------------------------------------------------------------
+// Name : Move ()
+// Desc : Accelerates the plane. Keeping it inside the world is left to the
+//		clamp box Update gives its body.
+//-----------------------------------------------------------------------------
+void CPlayer::Move(ULONG ulDirection)
+{
+	Vec2 velocity = Velocity();
 
 	if( ulDirection & CPlayer::DIR_LEFT )
-		m_pSprite->mVelocity.x -= 1.1;
+		velocity.x -= 1.1;
 
 	if( ulDirection & CPlayer::DIR_RIGHT )
-		m_pSprite->mVelocity.x += 1.1;
+		velocity.x += 1.1;
 
 	if( ulDirection & CPlayer::DIR_FORWARD )
-		m_pSprite->mVelocity.y -= 1.1;
+		velocity.y -= 1.1;
 
 	if( ulDirection & CPlayer::DIR_BACKWARD )
-		m_pSprite->mVelocity.y += 1.1;
-	
-	
+		velocity.y += 1.1;
+
+	SetVelocity(velocity);
 }
 
 
-Vec2& CPlayer::Position()
+Vec2 CPlayer::Position() const
 {
-	return m_pSprite->mPosition;
+	return g_App.GetKinematics().GetPosition(m_nBody);
 
 }
 
-Vec2& CPlayer::Velocity()
+Vec2 CPlayer::Velocity() const
 {
-	return m_pSprite->mVelocity;
+	return g_App.GetKinematics().GetVelocity(m_nBody);
 }
 
+//-----------------------------------------------------------------------------
+// Name : Explode ()
+// Desc : Starts the explosion; ExplosionScript plays it out.
+//-----------------------------------------------------------------------------
 void CPlayer::Explode()
 {
-	m_pExplosionSprite->mPosition = m_pSprite->mPosition;
+	if (!m_bExplosion)
+		g_App.GetScripts().Spawn(ExplosionScript());
+
+	m_pExplosionSprite->mPosition = Position();
 	m_pExplosionSprite->SetFrame(0);
-	PlaySound("data/explosion.wav", NULL, SND_FILENAME | SND_ASYNC);
+	g_App.GetAssets().PlaySoundAsset("data/explosion.wav");
 	m_bExplosion = true;
 }
 
@@ -197,7 +271,7 @@ bool CPlayer::AdvanceExplosion()
 		{
 			m_bExplosion = false;
 			m_iExplosionFrame = 0;
-			m_pSprite->mVelocity = Vec2(0,0);
+			SetVelocity(Vec2(0,0));
 			
 			
 			m_eSpeedState = SPEED_STOP;
@@ -208,135 +282,237 @@ bool CPlayer::AdvanceExplosion()
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Name : ExplosionScript () (Private)
+// Desc : Steps the explosion animation until it ends, then signals
+//		EVENT_EXPLOSION_DONE.
+//-----------------------------------------------------------------------------
+CScript CPlayer::ExplosionScript()
+{
+	do
+		co_await CScriptRuntime::WaitTicks(EXPLOSION_TICKS);
+	while (AdvanceExplosion());
 
+	g_App.GetScripts().Signal(CGameApp::EVENT_EXPLOSION_DONE);
+}
 
-void CPlayer::Shoot(int x)
+//-----------------------------------------------------------------------------
+// Name : Reload ()
+// Desc : Sets the weapon cooldown to nTicks and makes sure it counts down.
+//-----------------------------------------------------------------------------
+void CPlayer::Reload(int nTicks)
 {
-	if (fireCooldown < 25) {
-		bullet = new Sprite("data/b.bmp", "data/bm.bmp");
-		bullet->setBackBuffer(g_App.m_pBBuffer);
-		if (x == 1) {
-			bullet->mPosition.y = m_pSprite->mPosition.y - m_pSprite->height() / 2;
-			bullet->mPosition.x = m_pSprite->mPosition.x;
-		}
-		else {
-			bullet->mPosition.y = m_pSprite->mPosition.y + m_pSprite->height() / 2;
-			bullet->mPosition.x = m_pSprite->mPosition.x;
-		}
-		bullets.push_back(bullet);
-		fireCooldown = 100;
+	fireCooldown = nTicks;
+	if (!m_bReloading)
+		g_App.GetScripts().Spawn(ReloadScript());
+}
 
+//-----------------------------------------------------------------------------
+// Name : ReloadScript () (Private)
+// Desc : Counts fireCooldown down one per tick. It stays a plain counter
+//		because CSimState and the CPU player read it; the script only runs
+//		while there is something to count.
+//-----------------------------------------------------------------------------
+CScript CPlayer::ReloadScript()
+{
+	m_bReloading = true;
+	while (fireCooldown > 1)
+	{
+		co_await CScriptRuntime::WaitTicks(1);
+		fireCooldown--;
 	}
+	m_bReloading = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Respawn ()
+// Desc : Puts the plane back at its kind's spawn point, stopped, with the
+//		first shot delayed.
+//-----------------------------------------------------------------------------
+void CPlayer::Respawn()
+{
+	SetPosition(Vec2(m_pType->fSpawnX, m_pType->fSpawnY));
+	SetVelocity(Vec2(0, 0));
+	Reload(m_pWeapon->nFirstShotTicks);
+}
 
+//-----------------------------------------------------------------------------
+// Name : Shoot ()
+// Desc : Spawns a bullet at the plane's muzzle edge once the weapon is ready.
+//-----------------------------------------------------------------------------
+void CPlayer::Shoot()
+{
+	if (fireCooldown < m_pWeapon->nReadyBelow) {
+		Vec2 position = Position();
+		position.y -= m_pType->nShootDir * (m_pSprite->height() / 2);
+		bullets.push_back(g_App.GetKinematics().Create(position, Vec2(0, 0)));
+		Reload(m_pWeapon->nReloadTicks);
+	}
 }
 
 bool CPlayer::Collision(CPlayer* p1, CPlayer* p2)
 {
+	Vec2 p1Position = p1->Position();
+	Vec2 p2Position = p2->Position();
+
 	RECT r;
-	r.left = p1->m_pSprite->mPosition.x - p1->m_pSprite->width() / 2;
-	r.right = p1->m_pSprite->mPosition.x + p1->m_pSprite->width() / 2;
-	r.top = p1->m_pSprite->mPosition.y - p1->m_pSprite->height() / 2;
-	r.bottom = p1->m_pSprite->mPosition.y + p1->m_pSprite->height() / 2;
+	r.left = p1Position.x - p1->m_pSprite->width() / 2;
+	r.right = p1Position.x + p1->m_pSprite->width() / 2;
+	r.top = p1Position.y - p1->m_pSprite->height() / 2;
+	r.bottom = p1Position.y + p1->m_pSprite->height() / 2;
 
 	RECT r2;
-	r2.left = p2->m_pSprite->mPosition.x - p2->m_pSprite->width() / 2;
-	r2.right = p2->m_pSprite->mPosition.x + p2->m_pSprite->width() / 2;
-	r2.top = p2->m_pSprite->mPosition.y - p2->m_pSprite->height() / 2;
-	r2.bottom = p2->m_pSprite->mPosition.y + p2->m_pSprite->height() / 2;
+	r2.left = p2Position.x - p2->m_pSprite->width() / 2;
+	r2.right = p2Position.x + p2->m_pSprite->width() / 2;
+	r2.top = p2Position.y - p2->m_pSprite->height() / 2;
+	r2.bottom = p2Position.y + p2->m_pSprite->height() / 2;
 
 
 	if (r.right > r2.left && r.left < r2.right && r.bottom>r2.top && r.top < r2.bottom) {
-		return true;
-	}
-	if (r.left > r2.right && r.right < r2.left && r.bottom>r2.top && r.top < r2.bottom) {		
-		return true;
+		// Boxes touch, only count it if opaque pixels do too
+		return CCollisionMask::Overlap(g_App.GetPlaneMask(p1->m_eFacing), r.left, r.top,
+									   g_App.GetPlaneMask(p2->m_eFacing), r2.left, r2.top);
 	}
 
 	return false;
 	
 }
 
-bool CPlayer::bulletCollision(CPlayer* p1, CPlayer* p2,int x)
+//-----------------------------------------------------------------------------
+// Name : SweepBullets ()
+// Desc : Sweeps every live bullet over the motion CKinematics is about to
+//		integrate for this tick against pTarget, moving over dt as well. A
+//		box hit is then walked pixel by pixel against the masks; the earliest
+//		bullet to touch opaque pixels is removed and reported as the hit.
+//-----------------------------------------------------------------------------
+bool CPlayer::SweepBullets(CPlayer* pTarget, float dt)
 {
-	RECT r;
-	r.left = p2->m_pSprite->mPosition.x - p2->m_pSprite->width() / 2;
-	r.right = p2->m_pSprite->mPosition.x + p2->m_pSprite->width() / 2;
-	r.top = p2->m_pSprite->mPosition.y - p2->m_pSprite->height() / 2;
-	r.bottom = p2->m_pSprite->mPosition.y + p2->m_pSprite->height() / 2;
-
-	RECT r2;
-	r2.left = p1->bullet->mPosition.x - p1->bullet->width() / 2;
-	r2.right = p1->bullet->mPosition.x + p1->bullet->width() / 2;
-	r2.top = p1->bullet->mPosition.y - p1->bullet->height() / 2;
-	r2.bottom = p1->bullet->mPosition.y + p1->bullet->height() / 2;
-	 
-	if (x == 1) {
-		if (r.right > r2.left && r.left < r2.right && r.bottom>r2.top && r.top < r2.bottom) {
-			p1->bullet->mPosition.y = -100;
-			return true;
-		}
-		if (r.left > r2.right && r.right < r2.left && r.bottom>r2.top && r.top < r2.bottom) {
-			p1->bullet->mPosition.y = -100;
-			return true;
-		}
+	int nCount = (int)bullets.size();
+	if (nCount == 0) return false;
+
+	// Structure of arrays for the batched test, frame scratch
+	const CKinematics& Kinematics = g_App.GetKinematics();
+	float* pX		= g_App.GetFrameArena().AllocArray<float>(nCount * 6);
+	if (pX == NULL) return false;
+	float* pY		= pX + nCount;
+	float* pDX		= pY + nCount;
+	float* pDY		= pDX + nCount;
+	float* pEnter	= pDY + nCount;
+	float* pExit	= pEnter + nCount;
+
+	for (int i = 0; i < nCount; ++i)
+	{
+		Vec2 position = Kinematics.GetPosition(bullets[i]);
+		Vec2 velocity = Kinematics.GetVelocity(bullets[i]);
+		pX[i]	= (float)position.x;
+		pY[i]	= (float)position.y;
+		pDX[i]	= (float)(velocity.x * dt);
+		pDY[i]	= (float)(velocity.y * dt);
 	}
-	else {
-		if (r.right > r2.left && r.left < r2.right && r.bottom>r2.top && r.top < r2.bottom) {
-			p1->bullet->mPosition.y = 2000;
-			return true;
-		}
-		if (r.left > r2.right && r.right < r2.left && r.bottom>r2.top && r.top < r2.bottom) {
-			p1->bullet->mPosition.y = 2000;
-			return true;
-		}
 
-	}
+	Sprite* pPlane = pTarget->m_pSprite;
+	Vec2 planePosition = pTarget->Position();
+	Vec2 planeVelocity = pTarget->Velocity();
+	CSweptCollision::Box Target;
+	Target.x		= (float)planePosition.x;
+	Target.y		= (float)planePosition.y;
+	Target.dx		= (float)(planeVelocity.x * dt);
+	Target.dy		= (float)(planeVelocity.y * dt);
+	Target.fHalfW	= pPlane->width() * 0.5f;
+	Target.fHalfH	= pPlane->height() * 0.5f;
+
+	if (CSweptCollision::SweepBullets(pX, pY, pDX, pDY, nCount, bullet->width() * 0.5f, bullet->height() * 0.5f, Target, pEnter, pExit) == 0)
+		return false;
+
+	const CCollisionMask& PlaneMask = g_App.GetPlaneMask(pTarget->m_eFacing);
+	const CCollisionMask& BulletMask = g_App.GetBulletMask();
+
+	int nHit = -1;
+	float fHit = CSweptCollision::NO_HIT;
+	for (int i = 0; i < nCount; ++i)
+	{
+		if (pEnter[i] >= fHit) continue;
 
-	
+		// About one sample per pixel of relative travel inside the box
+		float fTravel = (fabsf(pDX[i] - Target.dx) + fabsf(pDY[i] - Target.dy)) * (pExit[i] - pEnter[i]);
+		int nSteps = (int)fTravel < 64 ? (int)fTravel : 64;
 
-	return false;
+		for (int s = 0; s <= nSteps; ++s)
+		{
+			float t = pEnter[i] + (nSteps ? (pExit[i] - pEnter[i]) * s / nSteps : 0.0f);
+			int nPlaneX  = (int)(Target.x + Target.dx * t - pPlane->width() / 2);
+			int nPlaneY  = (int)(Target.y + Target.dy * t - pPlane->height() / 2);
+			int nBulletX = (int)(pX[i] + pDX[i] * t - bullet->width() / 2);
+			int nBulletY = (int)(pY[i] + pDY[i] * t - bullet->height() / 2);
 
+			if (t < fHit && CCollisionMask::Overlap(PlaneMask, nPlaneX, nPlaneY, BulletMask, nBulletX, nBulletY))
+			{
+				nHit = i;
+				fHit = t;
+				break;
+			}
+		}
+	}
+
+	if (nHit < 0) return false;
+
+	g_App.GetKinematics().Destroy(bullets[nHit]);
+	bullets[nHit] = bullets.back();
+	bullets.pop_back();
+	return true;
 }
 
-void CPlayer::fire(int x,int y) {
-	for (Sprite* it : bullets) {
-		it->draw();
-		it->mPosition.y += x;
-		it->mVelocity.y = x;
-		it->mPosition.x += y;
-		it->mVelocity.x = y;
+//-----------------------------------------------------------------------------
+// Name : fire ()
+// Desc : Points every live bullet along the aim at the weapon's speed and
+//		despawns those that left the world. CKinematics moves them, drawing
+//		happens in DrawBullets.
+//-----------------------------------------------------------------------------
+void CPlayer::fire() {
+	const CCamera& Camera = g_App.GetCamera();
+	CKinematics& Kinematics = g_App.GetKinematics();
+	const FacingType& Aim = FACING_TYPES[GetAim()];
+	Vec2 velocity(Aim.nStepX * m_pWeapon->fBulletSpeed, Aim.nStepY * m_pWeapon->fBulletSpeed);
+
+	for (size_t i = 0; i < bullets.size(); ) {
+		int nBody = bullets[i];
+
+		// Despawn bullets that left the world
+		if (!Camera.IsInWorld(Kinematics.GetPosition(nBody), bullet->width(), bullet->height())) {
+			Kinematics.Destroy(nBody);
+			bullets[i] = bullets.back();
+			bullets.pop_back();
+			continue;
+		}
+
+		Kinematics.SetVelocity(nBody, velocity);
+		++i;
 	}
 }
 
 void CPlayer::RotateLeft()
 {
-	auto position = m_pSprite->mPosition;
-	auto velocity = m_pSprite->mVelocity;
+	SetFacing(FACING_TYPES[m_eFacing].eRotateLeft);
+}
 
-	
+//-----------------------------------------------------------------------------
+// Name : SetFacing () (Private)
+// Desc : Shows the preloaded plane bitmap for a facing.
+//-----------------------------------------------------------------------------
+void CPlayer::SetFacing(FACING Facing)
+{
+	m_pSprite		= m_pPlaneSprites[Facing];
+	m_nSpriteRegion	= m_nPlaneRegions[Facing];
+	m_eFacing		= Facing;
+}
 
-	switch (rotateDirection)
-	{
-	case CPlayer::DIR_FORWARD:
-		m_pSprite = new Sprite("data/planeimgandmaskLeft.bmp", RGB(0xff, 0x00, 0xff));
-		rotateDirection = CPlayer::DIR_LEFT;
-		break;
-	case CPlayer::DIR_BACKWARD:
-		m_pSprite = new Sprite("data/planeimgandmaskRight.bmp", RGB(0xff, 0x00, 0xff));
-		rotateDirection = CPlayer::DIR_RIGHT;
-		break;
-	case CPlayer::DIR_LEFT:
-		rotateDirection = CPlayer::DIR_BACKWARD;
-		m_pSprite = new Sprite("data/planeimgandmaskk.bmp", RGB(0xff, 0x00, 0xff));
-		break;
-	case CPlayer::DIR_RIGHT:
-		m_pSprite = new Sprite("data/planeimgandmask.bmp", RGB(0xff, 0x00, 0xff));
-		rotateDirection = CPlayer::DIR_FORWARD;
-		break;
-	}
-	m_pSprite->mPosition = position;
-	m_pSprite->mVelocity = velocity;
-	m_pSprite->setBackBuffer(g_App.m_pBBuffer);
+//-----------------------------------------------------------------------------
+// Name : GetAim () (Private)
+// Desc : The facing bullets fly along, fixed per kind or the plane's own.
+//-----------------------------------------------------------------------------
+FACING CPlayer::GetAim() const
+{
+	return (m_pType->eAim == FACING_ANY) ? m_eFacing : m_pType->eAim;
 }
 
 int CPlayer::GetLives()
@@ -354,5 +530,42 @@ void CPlayer::SetLives(int currentLive) {
 }
 
 void CPlayer::SetPosition(Vec2 currentPosition) {
-	m_pSprite->mPosition = currentPosition;
+	g_App.GetKinematics().SetPosition(m_nBody, currentPosition);
+}
+
+void CPlayer::SetVelocity(Vec2 currentVelocity) {
+	g_App.GetKinematics().SetVelocity(m_nBody, currentVelocity);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SaveSimState ()
+// Desc : Copies this player and its bullets into slot nIndex of State.
+//-----------------------------------------------------------------------------
+void CPlayer::SaveSimState(CSimState& State, int nIndex)
+{
+	const CKinematics& Kinematics = g_App.GetKinematics();
+	Vec2 position = Kinematics.GetPosition(m_nBody);
+	Vec2 velocity = Kinematics.GetVelocity(m_nBody);
+
+	SimPlayer& p = State.Players[nIndex];
+	p.x			= (float)position.x;
+	p.y			= (float)position.y;
+	p.vx		= (float)velocity.x;
+	p.vy		= (float)velocity.y;
+	p.HalfW		= m_pSprite->width() / 2.0f;
+	p.HalfH		= m_pSprite->height() / 2.0f;
+	p.FireX		= (float)FACING_TYPES[GetAim()].nStepX;
+	p.FireY		= (float)FACING_TYPES[GetAim()].nStepY;
+	p.ShootDir	= (float)m_pType->nShootDir;
+	p.Lives		= playerLives;
+	p.Cooldown	= fireCooldown;
+	p.Weapon	= m_pType->eWeapon;
+
+	State.fBulletHalfW = bullet->width() / 2.0f;
+	State.fBulletHalfH = bullet->height() / 2.0f;
+	for (int nBody : bullets)
+	{
+		Vec2 position = Kinematics.GetPosition(nBody);
+		State.AddBullet(nIndex, (float)position.x, (float)position.y);
+	}
 }
\ No newline at end of file
@@ -15,7 +15,11 @@
 //-----------------------------------------------------------------------------
 #include "Main.h"
 #include "Sprite.h"
-#include <list>
+#include "CSimState.h"
+#include "CRenderQueue.h"
+#include "CScriptRuntime.h"
+#include "EntityTypes.h"
+#include <vector>
 //-----------------------------------------------------------------------------
 // Main Class Definitions
 //-----------------------------------------------------------------------------
@@ -29,6 +33,7 @@ public:
 	//-------------------------------------------------------------------------
 	// Enumerators
 	//-------------------------------------------------------------------------
+	// Movement input flags only, the way a plane faces is FACING (EntityTypes.h)
 	enum DIRECTION 
 	{ 
 		DIR_FORWARD	 = 1, 
@@ -43,55 +48,87 @@ public:
 		SPEED_STOP
 	};
 
-	//Variables for rotate and lives
-	DIRECTION rotateDirection;
+	//Variables for lives
 	int playerLives;
 
 	//-------------------------------------------------------------------------
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
-			 CPlayer(const BackBuffer *pBackBuffer,int x);
+			 CPlayer(const BackBuffer *pBackBuffer, ENTITY_KIND Kind);
 			 
 	virtual ~CPlayer();
 
+	// Owns its sprites, a copy would delete them twice
+			 CPlayer(const CPlayer&) = delete;
+	CPlayer&				operator=(const CPlayer&) = delete;
+
 
 	
 	//-------------------------------------------------------------------------
 	// Public Functions for This Class.
 	//-------------------------------------------------------------------------
 	void					Update( float dt );
-	void					Draw();
+	void					Draw(CRenderQueue& Queue);
+	void					DrawBullets(CRenderQueue& Queue);
 	void					Move(ULONG ulDirection);
-	Vec2&					Position();
-	Vec2&					Velocity();
+	Vec2					Position() const;
+	Vec2					Velocity() const;
 
-	void                    Shoot(int x);
+	void                    Shoot();
 	void					Explode();
 	bool					AdvanceExplosion();
-	int                     fireCooldown = 30;
+	void					Reload(int nTicks);
+	void					Respawn();
+	int                     fireCooldown;
 	bool                    Collision(CPlayer* p1, CPlayer* p2);
-	bool                    bulletCollision(CPlayer* p1, CPlayer* p2,int x);
-	void                    fire(int x,int y);
+	bool					SweepBullets(CPlayer* pTarget, float dt);
+	size_t					GetBulletCount() const { return bullets.size(); }
+	void                    fire();
 	void                    RotateLeft();
+	FACING					GetFacing() const { return m_eFacing; }
+	bool					HasAtlasRegions() const;
 	int                     GetLives();
 	void                    DecreaseLives();
 	void					SetLives(int lives);
 	void					SetPosition(Vec2 position);
+	void					SetVelocity(Vec2 velocity);
+	void					SaveSimState(CSimState& State, int nIndex);
+
 private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					DrawSprite(CRenderQueue& Queue, CRenderQueue::LAYER Layer, Sprite* pSprite, int nRegion, const Vec2& Position);
+	void					SetFacing(FACING Facing);
+	FACING					GetAim() const;
+	CScript					ExplosionScript();
+	CScript					ReloadScript();
+
 	//-------------------------------------------------------------------------
 	// Private Variables for This Class.
 	//-------------------------------------------------------------------------
-	Sprite*					m_pSprite;
+	Sprite*					m_pSprite;			// One of m_pPlaneSprites, the current facing
+	Sprite*					m_pPlaneSprites[FACING_COUNT];
+	int						m_nPlaneRegions[FACING_COUNT];
+	const EntityType*		m_pType;			// Row of ENTITY_TYPES this plane was built as
+	const WeaponType*		m_pWeapon;
 	Sprite*					enemy;
-	Sprite*                 bullet;
+	Sprite*                 bullet;				// One sprite for every bullet, deleted only in ~CPlayer
 	ESpeedStates			m_eSpeedState;
 	float					m_fTimer;
+	bool					m_bReloading;		// ReloadScript is counting fireCooldown down
 	
-	std::list<Sprite*>	    bullets;
+	int						m_nBody;			// Plane's body in g_App's CKinematics
+	std::vector<int>		bullets;			// Bullet bodies in g_App's CKinematics
 
 	bool					m_bExplosion;
 	AnimatedSprite*			m_pExplosionSprite;
 	int						m_iExplosionFrame;
+
+	FACING					m_eFacing;			// Which plane bitmap m_pSprite shows
+	int						m_nSpriteRegion;	// Sprite atlas regions, -1 when not packed
+	int						m_nBulletRegion;
+	int						m_nExplosionRegion;	// First frame, the others follow it
 	
 };
 
@@ -0,0 +1,133 @@
+//-----------------------------------------------------------------------------
+// File: CRenderQueue.cpp
+//
+// Desc: Per frame render command buffer. Game objects only emit compact draw
+//	   commands during DrawObjects; the queue is then sorted by layer and
+//	   texture and executed against the back buffer in a single pass.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRenderQueue Specific Includes
+//-----------------------------------------------------------------------------
+#include "CRenderQueue.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Name : CRenderQueue () (Constructor)
+// Desc : CRenderQueue Class Constructor
+//-----------------------------------------------------------------------------
+CRenderQueue::CRenderQueue()
+{
+	m_Commands.reserve( 256 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CRenderQueue () (Destructor)
+// Desc : CRenderQueue Class Destructor
+//-----------------------------------------------------------------------------
+CRenderQueue::~CRenderQueue()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Begin ()
+// Desc : Starts a new frame, keeping the allocated capacity.
+//-----------------------------------------------------------------------------
+void CRenderQueue::Begin()
+{
+	m_Commands.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddImage ()
+// Desc : Queues a full image paint with its top left corner at (x, y).
+//-----------------------------------------------------------------------------
+void CRenderQueue::AddImage( LAYER Layer, const CImageFile* pImage, int x, int y )
+{
+	Add( Layer, TEXTURE_IMAGE, -1, pImage, x, y );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddAtlas ()
+// Desc : Queues an atlas region centred on (x, y).
+//-----------------------------------------------------------------------------
+void CRenderQueue::AddAtlas( LAYER Layer, int nRegion, int x, int y )
+{
+	Add( Layer, TEXTURE_ATLAS, nRegion, NULL, x, y );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddSprite ()
+// Desc : Queues a sprite that has no atlas region, drawn centred on (x, y).
+//-----------------------------------------------------------------------------
+void CRenderQueue::AddSprite( LAYER Layer, Sprite* pSprite, int x, int y )
+{
+	Add( Layer, TEXTURE_SPRITE, -1, pSprite, x, y );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Sort ()
+// Desc : Orders by layer, then texture, then submission order, so draws that
+//		share a surface run back to back while the result stays deterministic.
+//-----------------------------------------------------------------------------
+void CRenderQueue::Sort()
+{
+	std::sort( m_Commands.begin(), m_Commands.end(),
+		[]( const RenderCommand& a, const RenderCommand& b ) { return a.SortKey < b.SortKey; } );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Execute ()
+// Desc : Runs every queued command against hDC in queue order.
+//-----------------------------------------------------------------------------
+void CRenderQueue::Execute( HDC hDC, const CSpriteAtlas& Atlas ) const
+{
+	for ( size_t i = 0; i < m_Commands.size(); ++i )
+		ExecuteCommand( hDC, Atlas, m_Commands[i] );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ExecuteCommand () (Static)
+// Desc : Draws a single command with GDI.
+//-----------------------------------------------------------------------------
+void CRenderQueue::ExecuteCommand( HDC hDC, const CSpriteAtlas& Atlas, const RenderCommand& Cmd )
+{
+	switch ( GetTexture( Cmd ) )
+	{
+	case TEXTURE_IMAGE:
+		((CImageFile*)Cmd.pSource)->Paint( hDC, Cmd.x, Cmd.y );
+		break;
+
+	case TEXTURE_ATLAS:
+		Atlas.Draw( hDC, Cmd.nRegion, Cmd.x, Cmd.y );
+		break;
+
+	case TEXTURE_SPRITE:
+		{
+			// Sprite draws at its own position, point it at the recorded one.
+			// This writes the live Sprite, so queues holding these commands
+			// are only executed on the game thread (see CGameApp::BuildObjects)
+			Sprite* pSprite	= (Sprite*)Cmd.pSource;
+			Vec2	Old		= pSprite->mPosition;
+			pSprite->mPosition = Vec2( Cmd.x, Cmd.y );
+			pSprite->draw();
+			pSprite->mPosition = Old;
+		}
+		break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add () (Private)
+// Desc : Appends a command with its sort key.
+//-----------------------------------------------------------------------------
+void CRenderQueue::Add( LAYER Layer, TEXTURE Texture, int nRegion, const void* pSource, int x, int y )
+{
+	RenderCommand Cmd;
+	Cmd.SortKey	= ( (ULONGLONG)Layer << 40 ) | ( (ULONGLONG)Texture << 32 ) | (ULONGLONG)m_Commands.size();
+	Cmd.nRegion	= nRegion;
+	Cmd.pSource	= pSource;
+	Cmd.x		= x;
+	Cmd.y		= y;
+	m_Commands.push_back( Cmd );
+}
@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// File: CRenderQueue.h
+//
+// Desc: Per frame render command buffer. Game objects only emit compact draw
+//	   commands during DrawObjects; the queue is then sorted by layer and
+//	   texture and executed against the back buffer in a single pass.
+//-----------------------------------------------------------------------------
+
+#ifndef _CRENDERQUEUE_H_
+#define _CRENDERQUEUE_H_
+
+//-----------------------------------------------------------------------------
+// CRenderQueue Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "Sprite.h"
+#include "ImageFile.h"
+#include "CSpriteAtlas.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Structure Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : RenderCommand (Struct)
+// Desc : One draw. Atlas draws are fully self contained; sprite and image
+//		draws point back at the object that owns the bitmap.
+//-----------------------------------------------------------------------------
+struct RenderCommand
+{
+	ULONGLONG			SortKey;	// Layer (8) | texture (8) | submission order (32)
+	int					nRegion;	// Atlas region for TEXTURE_ATLAS
+	const void*			pSource;	// Sprite* / CImageFile* for the other textures
+	int					x, y;		// Centre for sprites, top left for images
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CRenderQueue (Class)
+// Desc : Collects, sorts and executes one frame of render commands.
+//-----------------------------------------------------------------------------
+class CRenderQueue
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum LAYER
+	{
+		LAYER_BACKGROUND	= 0,
+		LAYER_PLANES		= 1,
+		LAYER_BULLETS		= 2,
+		LAYER_OVERLAY		= 3,
+	};
+
+	enum TEXTURE
+	{
+		TEXTURE_IMAGE		= 0,	// Full CImageFile paint
+		TEXTURE_ATLAS		= 1,	// Sub rect of the sprite atlas
+		TEXTURE_SPRITE		= 2,	// Sprite drawing its own bitmap (no atlas entry)
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CRenderQueue();
+	virtual ~CRenderQueue();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Begin( );
+	void					AddImage( LAYER Layer, const CImageFile* pImage, int x, int y );
+	void					AddAtlas( LAYER Layer, int nRegion, int x, int y );
+	void					AddSprite( LAYER Layer, Sprite* pSprite, int x, int y );
+	void					Sort( );
+	void					Execute( HDC hDC, const CSpriteAtlas& Atlas ) const;
+
+	const std::vector<RenderCommand>& GetCommands( ) const { return m_Commands; }
+
+	static TEXTURE			GetTexture( const RenderCommand& Cmd ) { return (TEXTURE)( ( Cmd.SortKey >> 32 ) & 0xFF ); }
+	static void				ExecuteCommand( HDC hDC, const CSpriteAtlas& Atlas, const RenderCommand& Cmd );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Add( LAYER Layer, TEXTURE Texture, int nRegion, const void* pSource, int x, int y );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<RenderCommand>	m_Commands;		// Capacity is kept between frames
+};
+
+//-----------------------------------------------------------------------------
+// Name : RenderSnapshot (Struct)
+// Desc : Everything the renderer needs to draw one simulated frame, handed
+//		from the simulation to the render thread.
+//-----------------------------------------------------------------------------
+struct RenderSnapshot
+{
+	CRenderQueue			Queue;		// Sorted draw commands
+	ULONG					nFrame;		// Simulation frame that produced it
+};
+
+#endif // _CRENDERQUEUE_H_
@@ -0,0 +1,255 @@
+//-----------------------------------------------------------------------------
+// File: CScriptRuntime.cpp
+//
+// Desc: Gameplay scripts as C++20 coroutines. A script is any function
+//	   returning CScript; it can co_await WaitTicks (simulation ticks, one
+//	   per AnimateObjects) and WaitEvent (until some script or game code
+//	   calls Signal). Frames come from a pooled free list and resuming
+//	   never allocates, so thousands of sleeping scripts cost nothing per
+//	   tick and the ones waking cost one resume each.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CScriptRuntime Specific Includes
+//-----------------------------------------------------------------------------
+#include "CScriptRuntime.h"
+#include <algorithm>
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+namespace
+{
+	// Coroutine frames by size class; bigger frames go to the heap directly
+	const size_t	FRAME_CLASSES[]		= { 128, 256, 512, 1024 };
+	const int		CLASS_COUNT			= sizeof(FRAME_CLASSES) / sizeof(FRAME_CLASSES[0]);
+	const size_t	BLOCKS_PER_CHUNK	= 64;
+
+	struct FreeBlock
+	{
+		FreeBlock*	pNext;
+	};
+
+	// Chunks are never returned: g_App releases its scripts during static
+	// destruction, after which this pool may already be gone if it freed
+	// anything itself. Usage stays at the peak number of live scripts.
+	FreeBlock*		g_pFreeFrames[CLASS_COUNT];
+
+	int FrameClass( size_t nSize )
+	{
+		for ( int i = 0; i < CLASS_COUNT; ++i )
+			if ( nSize <= FRAME_CLASSES[i] ) return i;
+		return -1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : operator new () (CScript::promise_type)
+// Desc : Takes a frame from the pool, carving a new chunk when it is empty.
+//-----------------------------------------------------------------------------
+void* CScript::promise_type::operator new( size_t nSize )
+{
+	int nClass = FrameClass( nSize );
+	if ( nClass < 0 ) return ::operator new( nSize );
+
+	if ( !g_pFreeFrames[nClass] )
+	{
+		size_t nBlock = FRAME_CLASSES[nClass];
+		BYTE*  pChunk = (BYTE*)::operator new( nBlock * BLOCKS_PER_CHUNK );
+		for ( size_t i = 0; i < BLOCKS_PER_CHUNK; ++i )
+		{
+			FreeBlock* pBlock		= (FreeBlock*)( pChunk + i * nBlock );
+			pBlock->pNext			= g_pFreeFrames[nClass];
+			g_pFreeFrames[nClass]	= pBlock;
+		}
+	}
+
+	FreeBlock* pBlock		= g_pFreeFrames[nClass];
+	g_pFreeFrames[nClass]	= pBlock->pNext;
+	return pBlock;
+}
+
+//-----------------------------------------------------------------------------
+// Name : operator delete () (CScript::promise_type)
+// Desc : Returns a frame to its size class.
+//-----------------------------------------------------------------------------
+void CScript::promise_type::operator delete( void* p, size_t nSize )
+{
+	int nClass = FrameClass( nSize );
+	if ( nClass < 0 ) { ::operator delete( p ); return; }
+
+	FreeBlock* pBlock		= (FreeBlock*)p;
+	pBlock->pNext			= g_pFreeFrames[nClass];
+	g_pFreeFrames[nClass]	= pBlock;
+}
+
+//-----------------------------------------------------------------------------
+// Name : await_suspend () (WaitTicks)
+// Desc : Parks the script in the wheel slot of its wake tick, or on the
+//		heap when that is a full turn of the wheel or more away.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::WaitTicks::await_suspend( CScript::Handle hScript )
+{
+	CScriptRuntime* pRuntime = hScript.promise().pRuntime;
+
+	if ( m_nTicks < WHEEL_SIZE )
+	{
+		pRuntime->m_Wheel[( pRuntime->m_nTick + m_nTicks ) % WHEEL_SIZE].push_back( hScript );
+		pRuntime->m_nWheelCount++;
+		return;
+	}
+
+	Timer t;
+	t.nWake		= pRuntime->m_nTick + m_nTicks;
+	t.nOrder	= pRuntime->m_nOrder++;
+	t.hScript	= hScript;
+	pRuntime->m_Timers.push_back( t );
+	std::push_heap( pRuntime->m_Timers.begin(), pRuntime->m_Timers.end(), Later );
+}
+
+//-----------------------------------------------------------------------------
+// Name : await_suspend () (WaitEvent)
+// Desc : Parks the script until its event is signalled.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::WaitEvent::await_suspend( CScript::Handle hScript )
+{
+	Waiter w;
+	w.nEvent	= m_nEvent;
+	w.hScript	= hScript;
+	hScript.promise().pRuntime->m_Waiters.push_back( w );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CScriptRuntime () (Constructor)
+// Desc : CScriptRuntime Class Constructor
+//-----------------------------------------------------------------------------
+CScriptRuntime::CScriptRuntime()
+{
+	m_nTick			= 0;
+	m_nOrder		= 0;
+	m_nWheelCount	= 0;
+	m_nResumed		= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CScriptRuntime () (Destructor)
+// Desc : CScriptRuntime Class Destructor
+//-----------------------------------------------------------------------------
+CScriptRuntime::~CScriptRuntime()
+{
+	Clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reserve ()
+// Desc : Sizes the queues for nScripts waiting at once, so neither waiting
+//		nor waking allocates below that. Wheel slots keep whatever capacity
+//		they grew to.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::Reserve( size_t nScripts )
+{
+	m_Timers.reserve( nScripts );
+	m_Waiters.reserve( nScripts );
+	m_Ready.reserve( nScripts );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Spawn ()
+// Desc : Adopts a script and runs it up to its first wait, right away.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::Spawn( CScript Script )
+{
+	CScript::Handle hScript = Script.m_hCoroutine;
+	Script.m_hCoroutine = NULL;
+
+	hScript.promise().pRuntime = this;
+	hScript.resume();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Tick ()
+// Desc : Advances simulation time by one tick and resumes every script due,
+//		plus any signalled since the last Tick. Scripts signalled while
+//		this runs are resumed before it returns.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::Tick()
+{
+	++m_nTick;
+
+	std::vector<CScript::Handle>& Slot = m_Wheel[m_nTick % WHEEL_SIZE];
+	m_nWheelCount -= Slot.size();
+	if ( m_Ready.empty() )
+		m_Ready.swap( Slot );		// Capacities just trade places
+	else
+		m_Ready.insert( m_Ready.end(), Slot.begin(), Slot.end() );
+	Slot.clear();
+
+	while ( !m_Timers.empty() && (LONG)( m_Timers.front().nWake - m_nTick ) <= 0 )
+	{
+		std::pop_heap( m_Timers.begin(), m_Timers.end(), Later );
+		m_Ready.push_back( m_Timers.back().hScript );
+		m_Timers.pop_back();
+	}
+
+	// Resuming may append to m_Ready, so no iterators
+	for ( m_nResumed = 0; m_nResumed < m_Ready.size(); )
+	{
+		CScript::Handle hScript = m_Ready[m_nResumed++];
+		hScript.resume();
+	}
+
+	m_Ready.clear();
+	m_nResumed = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Signal ()
+// Desc : Wakes every script waiting on nEvent, in the order they started
+//		waiting. Scripts that wait on it afterwards need the next Signal.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::Signal( ULONG nEvent )
+{
+	size_t nKept = 0;
+	for ( size_t i = 0; i < m_Waiters.size(); ++i )
+	{
+		if ( m_Waiters[i].nEvent == nEvent )
+			m_Ready.push_back( m_Waiters[i].hScript );
+		else
+			m_Waiters[nKept++] = m_Waiters[i];
+	}
+	m_Waiters.resize( nKept );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Destroys every suspended script without resuming it.
+//-----------------------------------------------------------------------------
+void CScriptRuntime::Clear()
+{
+	for ( std::vector<CScript::Handle>& Slot : m_Wheel )
+	{
+		for ( CScript::Handle hScript : Slot ) hScript.destroy();
+		Slot.clear();
+	}
+	m_nWheelCount = 0;
+
+	for ( const Timer& t : m_Timers )	t.hScript.destroy();
+	for ( const Waiter& w : m_Waiters )	w.hScript.destroy();
+	for ( size_t i = m_nResumed; i < m_Ready.size(); ++i ) m_Ready[i].destroy();
+
+	m_Timers.clear();
+	m_Waiters.clear();
+	m_Ready.clear();
+	m_nResumed = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Later () (Private, Static)
+// Desc : Heap order, the earliest wake (then the earliest wait) on top.
+//-----------------------------------------------------------------------------
+bool CScriptRuntime::Later( const Timer& a, const Timer& b )
+{
+	if ( a.nWake != b.nWake ) return (LONG)( a.nWake - b.nWake ) > 0;
+	return (LONG)( a.nOrder - b.nOrder ) > 0;
+}
@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// File: CScriptRuntime.h
+//
+// Desc: Gameplay scripts as C++20 coroutines. A script is any function
+//	   returning CScript; it can co_await WaitTicks (simulation ticks, one
+//	   per AnimateObjects) and WaitEvent (until some script or game code
+//	   calls Signal). Frames come from a pooled free list and resuming
+//	   never allocates, so thousands of sleeping scripts cost nothing per
+//	   tick and the ones waking cost one resume each.
+//-----------------------------------------------------------------------------
+
+#ifndef _CSCRIPTRUNTIME_H_
+#define _CSCRIPTRUNTIME_H_
+
+//-----------------------------------------------------------------------------
+// CScriptRuntime Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+class CScriptRuntime;
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CScript (Class)
+// Desc : Return type of a script coroutine. Scripts start suspended and are
+//		run by handing them to CScriptRuntime::Spawn; one that is never
+//		spawned is destroyed with this object. The frame frees itself when
+//		the script returns.
+//-----------------------------------------------------------------------------
+class CScript
+{
+public:
+	//-------------------------------------------------------------------------
+	// Name : promise_type (Struct)
+	// Desc : Coroutine plumbing. operator new / delete route the frame
+	//		through the runtime's pool.
+	//-------------------------------------------------------------------------
+	struct promise_type
+	{
+		CScriptRuntime*			pRuntime = NULL;	// Set by Spawn
+
+		CScript					get_return_object( )		{ return CScript( std::coroutine_handle<promise_type>::from_promise( *this ) ); }
+		std::suspend_always		initial_suspend( ) noexcept	{ return {}; }
+		std::suspend_never		final_suspend( ) noexcept	{ return {}; }
+		void					return_void( )				{ }
+		void					unhandled_exception( )		{ std::terminate(); }
+
+		static void*			operator new( size_t nSize );
+		static void				operator delete( void* p, size_t nSize );
+	};
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CScript( CScript&& Other ) noexcept : m_hCoroutine( Other.m_hCoroutine ) { Other.m_hCoroutine = NULL; }
+			~CScript( ) { if ( m_hCoroutine ) m_hCoroutine.destroy(); }
+
+	CScript&				operator=( const CScript& ) = delete;
+
+private:
+	friend class CScriptRuntime;
+	explicit				CScript( Handle hCoroutine ) : m_hCoroutine( hCoroutine ) { }
+
+	Handle					m_hCoroutine;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CScriptRuntime (Class)
+// Desc : Cooperative scheduler for CScripts. Game thread only: Spawn, Tick,
+//		Signal and the awaitables all run there (the frame pool is shared
+//		by every runtime and has no lock).
+//-----------------------------------------------------------------------------
+class CScriptRuntime
+{
+public:
+	//-------------------------------------------------------------------------
+	// Name : WaitTicks (Struct)
+	// Desc : co_await WaitTicks( n ) resumes n Ticks later, 0 does not wait.
+	//-------------------------------------------------------------------------
+	struct WaitTicks
+	{
+		explicit				WaitTicks( ULONG nTicks ) : m_nTicks( nTicks ) { }
+		bool					await_ready( ) const noexcept { return m_nTicks == 0; }
+		void					await_suspend( CScript::Handle hScript );
+		void					await_resume( ) const noexcept { }
+
+		ULONG					m_nTicks;
+	};
+
+	//-------------------------------------------------------------------------
+	// Name : WaitEvent (Struct)
+	// Desc : co_await WaitEvent( id ) resumes after the next Signal( id ).
+	//-------------------------------------------------------------------------
+	struct WaitEvent
+	{
+		explicit				WaitEvent( ULONG nEvent ) : m_nEvent( nEvent ) { }
+		bool					await_ready( ) const noexcept { return false; }
+		void					await_suspend( CScript::Handle hScript );
+		void					await_resume( ) const noexcept { }
+
+		ULONG					m_nEvent;
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CScriptRuntime();
+	virtual ~CScriptRuntime();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Reserve( size_t nScripts );
+	void					Spawn( CScript Script );
+	void					Tick( );
+	void					Signal( ULONG nEvent );
+	void					Clear( );
+	ULONG					GetTick( ) const { return m_nTick; }
+	size_t					GetCount( ) const { return m_nWheelCount + m_Timers.size() + m_Waiters.size() + m_Ready.size() - m_nResumed; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		WHEEL_SIZE		= 256,		// Waits shorter than this skip the heap
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct Timer
+	{
+		ULONG				nWake;			// Tick to resume on
+		ULONG				nOrder;			// Equal wake ticks resume in wait order
+		CScript::Handle		hScript;
+	};
+
+	struct Waiter
+	{
+		ULONG				nEvent;
+		CScript::Handle		hScript;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	static bool				Later( const Timer& a, const Timer& b );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	ULONG						m_nTick;
+	ULONG						m_nOrder;
+	std::vector<CScript::Handle> m_Wheel[WHEEL_SIZE];	// Short waits, slot = wake tick % WHEEL_SIZE
+	size_t						m_nWheelCount;
+	std::vector<Timer>			m_Timers;		// Long waits, min heap on ( nWake, nOrder )
+	std::vector<Waiter>			m_Waiters;		// In wait order
+	std::vector<CScript::Handle> m_Ready;		// Resumed by the current / next Tick
+	size_t						m_nResumed;		// m_Ready entries already resumed this Tick
+};
+
+#endif // _CSCRIPTRUNTIME_H_
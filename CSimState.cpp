@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// File: CSimState.cpp
+//
+// Desc: Compact, copyable snapshot of the match plus a step function that
+//	   advances it with the same rules CPlayer / CGameApp apply each frame.
+//	   Cloning is a plain struct copy, which makes it cheap enough for AI
+//	   rollouts.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSimState Specific Includes
+//-----------------------------------------------------------------------------
+#include "CSimState.h"
+#include "CPlayer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const float	ACCELERATION	= 1.1f;		// Velocity change per Move() call
+
+	inline bool Overlaps( float ax, float ay, float ahw, float ahh, float bx, float by, float bhw, float bhh )
+	{
+		return ax + ahw > bx - bhw && ax - ahw < bx + bhw && ay + ahh > by - bhh && ay - ahh < by + bhh;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const float CSimState::TICK_SECONDS = 1.0f / 60.0f;	// The tick EntityTypes.h timings count
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Clears bullets and sets up the playfield extents.
+//-----------------------------------------------------------------------------
+void CSimState::Reset( float fW, float fH )
+{
+	nBullets	= 0;
+	fWidth		= fW;
+	fHeight		= fH;
+	fBulletHalfW = fBulletHalfH = 0;
+	nTick		= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddBullet ()
+// Desc : Appends a bullet, silently dropped when the state is full.
+//-----------------------------------------------------------------------------
+bool CSimState::AddBullet( int nOwner, float x, float y )
+{
+	if ( nBullets >= MAX_BULLETS ) return false;
+
+	SimBullet& b = Bullets[nBullets++];
+	b.x		= x;
+	b.y		= y;
+	b.Owner	= nOwner;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Step ()
+// Desc : Advances the state by one frame. Mirrors CPlayer::Move, Update,
+//		Draw (cooldown), Shoot, fire and the collision handling in CGameApp.
+//-----------------------------------------------------------------------------
+void CSimState::Step( const SimInput Input[2], float dt )
+{
+	for ( int i = 0; i < 2; ++i )
+	{
+		SimPlayer& p = Players[i];
+
+		ULONG Dir = Input[i].Direction;
+		if ( Dir & CPlayer::DIR_LEFT )		p.vx -= ACCELERATION;
+		if ( Dir & CPlayer::DIR_RIGHT )		p.vx += ACCELERATION;
+		if ( Dir & CPlayer::DIR_FORWARD )	p.vy -= ACCELERATION;
+		if ( Dir & CPlayer::DIR_BACKWARD )	p.vy += ACCELERATION;
+
+		p.x += p.vx * dt;
+		p.y += p.vy * dt;
+
+		// Clamp to the playfield exactly like the plane's CKinematics body
+		if ( p.x < p.HalfW )				{ p.x = p.HalfW;				p.vx = 0; }
+		if ( p.x > fWidth - p.HalfW )		{ p.x = fWidth - p.HalfW;		p.vx = 0; }
+		if ( p.y < p.HalfH )				{ p.y = p.HalfH;				p.vy = 0; }
+		if ( p.y > fHeight - p.HalfH )		{ p.y = fHeight - p.HalfH;		p.vy = 0; }
+
+		const WeaponType& Weapon = WEAPON_TYPES[p.Weapon];
+		if ( p.Cooldown > 1 ) p.Cooldown--;
+		if ( Input[i].bShoot && p.Cooldown < Weapon.nReadyBelow )
+		{
+			AddBullet( i, p.x, p.y - p.ShootDir * p.HalfH );
+			p.Cooldown = Weapon.nReloadTicks;
+		}
+	}
+
+	// Move bullets and resolve hits, compacting the array as we go
+	int nLive = 0;
+	for ( int b = 0; b < nBullets; ++b )
+	{
+		SimBullet		Bullet	= Bullets[b];
+		const SimPlayer& Owner	= Players[Bullet.Owner];
+		SimPlayer&		Target	= Players[Bullet.Owner ^ 1];
+
+		float fSpeed = WEAPON_TYPES[Owner.Weapon].fBulletSpeed;
+		Bullet.x += Owner.FireX * fSpeed * dt;
+		Bullet.y += Owner.FireY * fSpeed * dt;
+
+		if ( Overlaps( Target.x, Target.y, Target.HalfW, Target.HalfH, Bullet.x, Bullet.y, fBulletHalfW, fBulletHalfH ) )
+		{
+			Target.Lives--;
+			continue;
+		}
+
+		if ( Bullet.x < 0 || Bullet.y < 0 || Bullet.x > fWidth || Bullet.y > fHeight ) continue;
+		Bullets[nLive++] = Bullet;
+	}
+	nBullets = nLive;
+
+	// Plane vs plane, both lose a life and go back to their start positions
+	const SimPlayer& a = Players[0];
+	const SimPlayer& b = Players[1];
+	if ( Overlaps( a.x, a.y, a.HalfW, a.HalfH, b.x, b.y, b.HalfW, b.HalfH ) )
+	{
+		for ( int i = 0; i < 2; ++i )
+		{
+			// Players[i] is plane kind KIND_PLAYER_1 + i, as in CGameApp
+			const EntityType& Type = ENTITY_TYPES[KIND_PLAYER_1 + i];
+			SimPlayer& p = Players[i];
+			p.Lives--;
+			p.x = Type.fSpawnX; p.y = Type.fSpawnY;
+			p.vx = p.vy = 0;
+		}
+	}
+
+	nTick++;
+}
@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// File: CSimState.h
+//
+// Desc: Compact, copyable snapshot of the match plus a step function that
+//	   advances it with the same rules CPlayer / CGameApp apply each frame.
+//	   Cloning is a plain struct copy, which makes it cheap enough for AI
+//	   rollouts.
+//-----------------------------------------------------------------------------
+
+#ifndef _CSIMSTATE_H_
+#define _CSIMSTATE_H_
+
+//-----------------------------------------------------------------------------
+// CSimState Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Main Structure Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : SimPlayer (Struct)
+// Desc : Kinematic and gameplay state of one plane.
+//-----------------------------------------------------------------------------
+struct SimPlayer
+{
+	float	x, y;			// Centre position
+	float	vx, vy;			// Velocity (pixels per second)
+	float	HalfW, HalfH;	// Half sprite extents
+	float	FireX, FireY;	// Direction of this player's bullets, see WeaponType::fBulletSpeed
+	float	ShootDir;		// +1 spawns bullets above the plane, -1 below
+	int		Lives;
+	int		Cooldown;		// Mirrors CPlayer::fireCooldown
+	int		Weapon;			// Index into WEAPON_TYPES
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimBullet (Struct)
+// Desc : A live bullet and the player that fired it.
+//-----------------------------------------------------------------------------
+struct SimBullet
+{
+	float	x, y;
+	int		Owner;
+};
+
+//-----------------------------------------------------------------------------
+// Name : SimInput (Struct)
+// Desc : Input applied to one player for one step.
+//-----------------------------------------------------------------------------
+struct SimInput
+{
+	ULONG	Direction;		// CPlayer::DIRECTION flags
+	bool	bShoot;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CSimState (Class)
+// Desc : Fixed capacity, trivially copyable game state.
+//-----------------------------------------------------------------------------
+class CSimState
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum { MAX_BULLETS = 64 };
+	static const float		TICK_SECONDS;	// One simulation tick, what rollouts step by
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Reset( float fWidth, float fHeight );
+	void					Step( const SimInput Input[2], float dt );
+	bool					AddBullet( int nOwner, float x, float y );
+
+	//-------------------------------------------------------------------------
+	// Public Variables for This Class.
+	//-------------------------------------------------------------------------
+	SimPlayer				Players[2];
+	SimBullet				Bullets[MAX_BULLETS];
+	int						nBullets;
+	float					fWidth;			// Playfield extents players are clamped to
+	float					fHeight;
+	float					fBulletHalfW;	// Half bullet sprite extents
+	float					fBulletHalfH;
+	int						nTick;
+};
+
+#endif // _CSIMSTATE_H_
@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+// File: CSoakTest.cpp
+//
+// Desc: Long running leak check. While the game plays itself (hidden window,
+//	   CPU players, scripted rotations) telemetry is sampled once a second;
+//	   at the end a least squares fit over each resource counter decides
+//	   whether anything kept growing.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSoakTest Specific Includes
+//-----------------------------------------------------------------------------
+#include "CSoakTest.h"
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+namespace
+{
+	const ULONG		SAMPLE_MS			= 1000;
+	const float		WARMUP_FRACTION		= 0.1f;
+	const size_t	MIN_SAMPLES			= 30;
+
+	// Per subsystem counters first (allocs, bytes, handles for each), then
+	// the process wide ones
+	enum { PROCESS_GDI = CTelemetry::SUB_COUNT * 3, PROCESS_USER, PROCESS_KERNEL, PROCESS_WORKING_SET, PROCESS_PRIVATE, METRIC_COUNT };
+
+	double MetricValue( const CTelemetry::Sample& In, int nMetric )
+	{
+		if ( nMetric < PROCESS_GDI )
+		{
+			const CTelemetry::Counters& c = In.Sub[nMetric / 3];
+			switch ( nMetric % 3 )
+			{
+			case 0:  return (double)c.nAllocs;
+			case 1:  return (double)c.nBytes;
+			default: return (double)c.nHandles;
+			}
+		}
+
+		switch ( nMetric )
+		{
+		case PROCESS_GDI:			return In.nGdiObjects;
+		case PROCESS_USER:			return In.nUserObjects;
+		case PROCESS_KERNEL:		return In.nKernelHandles;
+		case PROCESS_WORKING_SET:	return (double)In.nWorkingSet;
+		default:					return (double)In.nPrivateBytes;
+		}
+	}
+
+	void MetricName( int nMetric, char* szOut, size_t nSize )
+	{
+		static const char* const FIELDS[3]	= { "allocs", "bytes", "handles" };
+		static const char* const PROCESS[5]	= { "gdi_objects", "user_objects", "kernel_handles", "working_set", "private_bytes" };
+
+		if ( nMetric < PROCESS_GDI )
+			sprintf_s( szOut, nSize, "%s_%s", CTelemetry::GetName( (CTelemetry::SUBSYSTEM)( nMetric / 3 ) ), FIELDS[nMetric % 3] );
+		else
+			sprintf_s( szOut, nSize, "%s", PROCESS[nMetric - PROCESS_GDI] );
+	}
+
+	// Growth over the run allowed before a counter counts as leaking. Handle
+	// counts must stay flat, memory gets room for allocator and OS noise.
+	double MetricTolerance( int nMetric, double fMean )
+	{
+		if ( nMetric < PROCESS_GDI )
+		{
+			switch ( nMetric % 3 )
+			{
+			case 0:  return 64.0;
+			case 1:  return 256.0 * 1024.0;
+			default: return 2.0;
+			}
+		}
+
+		switch ( nMetric )
+		{
+		case PROCESS_WORKING_SET:	return 4.0 * 1024.0 * 1024.0 + fMean * 0.05;
+		case PROCESS_PRIVATE:		return 2.0 * 1024.0 * 1024.0 + fMean * 0.02;
+		default:					return 4.0;
+		}
+	}
+
+	void Report( const char* szLine )
+	{
+		OutputDebugStringA( szLine );
+		fputs( szLine, stderr );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : CSoakTest () (Constructor)
+// Desc : CSoakTest Class Constructor
+//-----------------------------------------------------------------------------
+CSoakTest::CSoakTest()
+{
+	m_bRunning		= false;
+	m_fSeconds		= 0.0f;
+	m_nStartTicks	= 0;
+	m_nNextSample	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSoakTest () (Destructor)
+// Desc : CSoakTest Class Destructor
+//-----------------------------------------------------------------------------
+CSoakTest::~CSoakTest()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+// Desc : Begins a run of fMinutes. szLogPath (may be NULL) receives every
+//		sample as CSV.
+//-----------------------------------------------------------------------------
+bool CSoakTest::Start( float fMinutes, const char* szLogPath )
+{
+	if ( fMinutes <= 0.0f ) return false;
+	if ( szLogPath && !m_Log.OpenLog( szLogPath ) ) return false;
+
+	m_fSeconds		= fMinutes * 60.0f;
+	m_Samples.reserve( (size_t)( m_fSeconds * 1000.0f / SAMPLE_MS ) + 16 );
+	m_Times.reserve( m_Samples.capacity() );
+	m_nStartTicks	= GetTickCount64();
+	m_nNextSample	= m_nStartTicks;
+	m_bRunning		= true;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetActions ()
+// Desc : The scripted input for a frame, on top of what the CPU players do.
+//		Rotations cycle every sprite facing, which used to load bitmaps.
+//-----------------------------------------------------------------------------
+ULONG CSoakTest::GetActions( ULONG nFrame ) const
+{
+	ULONG Actions = 0;
+	if ( nFrame % 240 == 0 ) Actions |= ACTION_ROTATE_1;
+	if ( nFrame % 390 == 0 ) Actions |= ACTION_ROTATE_2;
+	return Actions;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update ()
+// Desc : Call once per frame. Samples when due; returns false once the run
+//		is over.
+//-----------------------------------------------------------------------------
+bool CSoakTest::Update( ULONG nFrame )
+{
+	if ( !m_bRunning ) return false;
+
+	ULONGLONG nNow = GetTickCount64();
+	if ( nNow >= m_nNextSample && m_Samples.size() < m_Samples.capacity() )
+	{
+		CTelemetry::Sample Sample;
+		CTelemetry::Capture( Sample, nFrame );
+		m_Samples.push_back( Sample );
+		m_Times.push_back( ( nNow - m_nStartTicks ) / 1000.0f );
+		m_Log.WriteSample( Sample );
+		m_nNextSample += SAMPLE_MS;
+	}
+
+	return ( nNow - m_nStartTicks ) / 1000.0f < m_fSeconds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Finish ()
+// Desc : Ends the run and checks every counter. True when nothing leaks.
+//-----------------------------------------------------------------------------
+bool CSoakTest::Finish()
+{
+	if ( !m_bRunning ) return false;
+	m_bRunning = false;
+	m_Log.CloseLog();
+
+	char szLine[256];
+	sprintf_s( szLine, "Soak: %u samples over %.0f s\n", (unsigned)m_Samples.size(), m_fSeconds );
+	Report( szLine );
+
+	if ( m_Samples.size() < MIN_SAMPLES )
+	{
+		Report( "Soak: FAIL, too few samples for a trend\n" );
+		return false;
+	}
+
+	bool bPassed = true;
+	for ( int i = 0; i < METRIC_COUNT; ++i )
+		if ( !CheckTrend( i ) ) bPassed = false;
+
+	Report( bPassed ? "Soak: PASS\n" : "Soak: FAIL\n" );
+	return bPassed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckTrend () (Private)
+// Desc : Least squares slope of one counter after the warm up, projected
+//		over the rest of the run and compared with the metric's tolerance.
+//-----------------------------------------------------------------------------
+bool CSoakTest::CheckTrend( int nMetric )
+{
+	size_t nFirst = (size_t)( m_Samples.size() * WARMUP_FRACTION );
+	size_t nCount = m_Samples.size() - nFirst;
+
+	double fMeanT = 0.0, fMeanV = 0.0;
+	for ( size_t i = nFirst; i < m_Samples.size(); ++i )
+	{
+		fMeanT += m_Times[i];
+		fMeanV += MetricValue( m_Samples[i], nMetric );
+	}
+	fMeanT /= nCount;
+	fMeanV /= nCount;
+
+	double fCov = 0.0, fVar = 0.0;
+	for ( size_t i = nFirst; i < m_Samples.size(); ++i )
+	{
+		double dt = m_Times[i] - fMeanT;
+		fCov += dt * ( MetricValue( m_Samples[i], nMetric ) - fMeanV );
+		fVar += dt * dt;
+	}
+
+	double fSlope	= ( fVar > 0.0 ) ? fCov / fVar : 0.0;
+	double fGrowth	= fSlope * ( m_Times.back() - m_Times[nFirst] );
+	double fLimit	= MetricTolerance( nMetric, fMeanV );
+	bool   bLeaking	= fGrowth > fLimit;
+
+	char szName[64], szLine[256];
+	MetricName( nMetric, szName, sizeof(szName) );
+	sprintf_s( szLine, "Soak: %-20s mean %14.0f  growth %12.1f  limit %12.1f%s\n", szName, fMeanV, fGrowth, fLimit, bLeaking ? "  LEAK" : "" );
+	Report( szLine );
+
+	return !bLeaking;
+}
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// File: CSoakTest.h
+//
+// Desc: Long running leak check. While the game plays itself (hidden window,
+//	   CPU players, scripted rotations) telemetry is sampled once a second;
+//	   at the end a least squares fit over each resource counter decides
+//	   whether anything kept growing.
+//-----------------------------------------------------------------------------
+
+#ifndef _CSOAKTEST_H_
+#define _CSOAKTEST_H_
+
+//-----------------------------------------------------------------------------
+// CSoakTest Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CTelemetry.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSoakTest (Class)
+// Desc : Sample storage is reserved in Start so the test does not show up in
+//		the heap counters it is watching. The first WARMUP_FRACTION of the
+//		samples (caches filling, pools growing) is ignored by the fit.
+//-----------------------------------------------------------------------------
+class CSoakTest
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum ACTION
+	{
+		ACTION_ROTATE_1	= 1,			// Player 1 RotateLeft
+		ACTION_ROTATE_2	= 2,			// Player 2 RotateLeft
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSoakTest();
+	virtual ~CSoakTest();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Start( float fMinutes, const char* szLogPath );
+	bool					IsRunning( ) const { return m_bRunning; }
+	ULONG					GetActions( ULONG nFrame ) const;
+	bool					Update( ULONG nFrame );
+	bool					Finish( );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					CheckTrend( int nMetric );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	bool					m_bRunning;
+	float					m_fSeconds;				// Length of the run
+	ULONGLONG				m_nStartTicks;			// GetTickCount64 at Start
+	ULONGLONG				m_nNextSample;
+	std::vector<CTelemetry::Sample>	m_Samples;
+	std::vector<float>		m_Times;				// Seconds since Start, one per sample
+	CTelemetry				m_Log;					// Every sample, optional
+};
+
+#endif // _CSOAKTEST_H_
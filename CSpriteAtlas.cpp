@@ -0,0 +1,150 @@
+//-----------------------------------------------------------------------------
+// File: CSpriteAtlas.cpp
+//
+// Desc: Runtime side of the sprite atlas produced by tools/AtlasPacker. Holds
+//	   the packed image and mask selected into memory DCs for the lifetime
+//	   of the atlas, so every sprite draw blits from the same two surfaces.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpriteAtlas Specific Includes
+//-----------------------------------------------------------------------------
+#include "CSpriteAtlas.h"
+#include "CTelemetry.h"
+#include <sstream>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Name : CSpriteAtlas () (Constructor)
+// Desc : CSpriteAtlas Class Constructor
+//-----------------------------------------------------------------------------
+CSpriteAtlas::CSpriteAtlas()
+{
+	m_hImage	= NULL;
+	m_hMask		= NULL;
+	m_hImageDC	= NULL;
+	m_hMaskDC	= NULL;
+	m_hOldImage	= NULL;
+	m_hOldMask	= NULL;
+	m_nWidth	= 0;
+	m_nHeight	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CSpriteAtlas () (Destructor)
+// Desc : CSpriteAtlas Class Destructor
+//-----------------------------------------------------------------------------
+CSpriteAtlas::~CSpriteAtlas()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Load ()
+// Desc : Loads the atlas image, mask and index written by AtlasPacker,
+//		from the asset pack or loose files.
+//-----------------------------------------------------------------------------
+bool CSpriteAtlas::Load( CAssetPack& Assets, LPCTSTR szImage, LPCTSTR szMask, LPCTSTR szIndex, HDC hdcRef )
+{
+	Release();
+
+	size_t nIndexSize;
+	const BYTE* pIndex = Assets.GetData( szIndex, nIndexSize );
+	if ( !pIndex ) return false;
+
+	std::istringstream Index( std::string( (const char*)pIndex, nIndexSize ) );
+
+	std::string Line;
+	while ( std::getline( Index, Line ) )
+	{
+		if ( Line.empty() || Line[0] == '#' ) continue;
+
+		char	Name[128];
+		int		x, y, w, h;
+		if ( sscanf_s( Line.c_str(), "%127s %d %d %d %d", Name, (unsigned)sizeof(Name), &x, &y, &w, &h ) != 5 ) continue;
+
+		Region r;
+		r.Name		= Name;
+		r.rc.left	= x;
+		r.rc.top	= y;
+		r.rc.right	= x + w;
+		r.rc.bottom	= y + h;
+		m_Regions.push_back( r );
+	}
+
+	// Decoded once, the same pixels feed GDI and the software compositor
+	CBmpDecoder::Image Image, Mask;
+	if ( !Assets.DecodeBitmap( szImage, Image ) || !Assets.DecodeBitmap( szMask, Mask ) ) { Release(); return false; }
+	if ( Image.nWidth != Mask.nWidth || Image.nHeight != Mask.nHeight || m_Regions.empty() ) { Release(); return false; }
+
+	m_hImage	= CAssetPack::CreateBitmapFromImage( Image, hdcRef );
+	m_hMask		= CAssetPack::CreateBitmapFromImage( Mask, hdcRef );
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, ( m_hImage != NULL ) + ( m_hMask != NULL ) );
+	if ( !m_hImage || !m_hMask ) { Release(); return false; }
+
+	// Fold the mask into alpha, white mask pixels are transparent
+	m_nWidth	= Image.nWidth;
+	m_nHeight	= Image.nHeight;
+	m_Pixels.resize( Image.Pixels.size() );
+	for ( size_t i = 0; i < m_Pixels.size(); ++i )
+		m_Pixels[i] = ( Image.Pixels[i] & 0x00FFFFFF ) | ( ( Mask.Pixels[i] & 0xFF ) ? 0 : 0xFF000000 );
+
+	m_hImageDC	= CreateCompatibleDC( hdcRef );
+	m_hMaskDC	= CreateCompatibleDC( hdcRef );
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, ( m_hImageDC != NULL ) + ( m_hMaskDC != NULL ) );
+	m_hOldImage	= SelectObject( m_hImageDC, m_hImage );
+	m_hOldMask	= SelectObject( m_hMaskDC, m_hMask );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the GDI objects and the index.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::Release()
+{
+	if ( m_hImageDC ) { SelectObject( m_hImageDC, m_hOldImage ); DeleteDC( m_hImageDC ); }
+	if ( m_hMaskDC )  { SelectObject( m_hMaskDC, m_hOldMask );   DeleteDC( m_hMaskDC ); }
+	if ( m_hImage )   DeleteObject( m_hImage );
+	if ( m_hMask )    DeleteObject( m_hMask );
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, -( ( m_hImageDC != NULL ) + ( m_hMaskDC != NULL ) + ( m_hImage != NULL ) + ( m_hMask != NULL ) ) );
+
+	m_hImage	= NULL;
+	m_hMask		= NULL;
+	m_hImageDC	= NULL;
+	m_hMaskDC	= NULL;
+	m_Regions.clear();
+	m_Pixels.clear();
+	m_nWidth	= 0;
+	m_nHeight	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Find ()
+// Desc : Returns the region index for a sprite name, or -1.
+//-----------------------------------------------------------------------------
+int CSpriteAtlas::Find( LPCTSTR szName ) const
+{
+	for ( size_t i = 0; i < m_Regions.size(); ++i )
+		if ( m_Regions[i].Name == szName ) return (int)i;
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Draws a region centred on (x, y), the same anchor Sprite uses.
+//-----------------------------------------------------------------------------
+void CSpriteAtlas::Draw( HDC hdcDest, int nRegion, int x, int y ) const
+{
+	const RECT& rc = m_Regions[nRegion].rc;
+	int w = rc.right - rc.left;
+	int h = rc.bottom - rc.top;
+
+	x -= w / 2;
+	y -= h / 2;
+
+	BitBlt( hdcDest, x, y, w, h, m_hMaskDC,  rc.left, rc.top, SRCAND );
+	BitBlt( hdcDest, x, y, w, h, m_hImageDC, rc.left, rc.top, SRCPAINT );
+}
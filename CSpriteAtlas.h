@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// File: CSpriteAtlas.h
+//
+// Desc: Runtime side of the sprite atlas produced by tools/AtlasPacker. Holds
+//	   the packed image and mask selected into memory DCs for the lifetime
+//	   of the atlas, so every sprite draw blits from the same two surfaces.
+//-----------------------------------------------------------------------------
+
+#ifndef _CSPRITEATLAS_H_
+#define _CSPRITEATLAS_H_
+
+//-----------------------------------------------------------------------------
+// CSpriteAtlas Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CAssetPack.h"
+#include <vector>
+#include <string>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpriteAtlas (Class)
+// Desc : Named sub rectangles of one packed image / mask pair.
+//-----------------------------------------------------------------------------
+class CSpriteAtlas
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpriteAtlas();
+	virtual ~CSpriteAtlas();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Load( CAssetPack& Assets, LPCTSTR szImage, LPCTSTR szMask, LPCTSTR szIndex, HDC hdcRef );
+	void					Release( );
+	bool					IsLoaded( ) const { return m_hImageDC != NULL; }
+
+	int						Find( LPCTSTR szName ) const;
+	const RECT&				GetRect( int nRegion ) const { return m_Regions[nRegion].rc; }
+	void					Draw( HDC hdcDest, int nRegion, int x, int y ) const;
+
+	// 32 bit copy of the atlas for software rasterisers, alpha is 0 where
+	// the mask is transparent and 0xFF elsewhere.
+	const ULONG*			GetPixels( ) const { return m_Pixels.empty() ? NULL : &m_Pixels[0]; }
+	int						GetWidth( ) const { return m_nWidth; }
+	int						GetHeight( ) const { return m_nHeight; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures for This Class.
+	//-------------------------------------------------------------------------
+	struct Region
+	{
+		std::string		Name;
+		RECT			rc;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<Region>		m_Regions;
+	std::vector<ULONG>		m_Pixels;
+	int						m_nWidth;
+	int						m_nHeight;
+	HBITMAP					m_hImage;
+	HBITMAP					m_hMask;
+	HDC						m_hImageDC;
+	HDC						m_hMaskDC;
+	HGDIOBJ					m_hOldImage;
+	HGDIOBJ					m_hOldMask;
+};
+
+#endif // _CSPRITEATLAS_H_
@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------
+// File: CSweptCollision.cpp
+//
+// Desc: Continuous collision for fast moving boxes. Each bullet's motion over
+//	   a tick is swept against a target box (moving as well), giving the
+//	   fraction of the tick at which they first touch, so hits are not lost
+//	   however far a bullet travels per tick. Four bullets per SSE2 step.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSweptCollision Specific Includes
+//-----------------------------------------------------------------------------
+#include "CSweptCollision.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+	#define SWEPT_SSE2
+	#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const float CSweptCollision::NO_HIT = 2.0f;
+
+//-----------------------------------------------------------------------------
+// Module Local Helpers
+//-----------------------------------------------------------------------------
+namespace
+{
+	// Stands in for 1/0 so a zero motion axis gives huge but finite slab
+	// times, never the NaN that 0 * inf would
+	const float		HUGE_INV	= 1e30f;
+
+	inline float SafeInverse( float d )
+	{
+		if ( d == 0.0f ) return HUGE_INV;
+		return 1.0f / d;
+	}
+
+	// Ray from (px, py) along (dx, dy) against [minX, maxX] x [minY, maxY]
+	inline bool RayBox( float px, float py, float dx, float dy, float minX, float minY, float maxX, float maxY, float& fEnter, float& fExit )
+	{
+		float ix = SafeInverse( dx ), iy = SafeInverse( dy );
+		float tx1 = ( minX - px ) * ix, tx2 = ( maxX - px ) * ix;
+		float ty1 = ( minY - py ) * iy, ty2 = ( maxY - py ) * iy;
+
+		float tNear = std::max( std::min( tx1, tx2 ), std::min( ty1, ty2 ) );
+		float tFar	= std::min( std::max( tx1, tx2 ), std::max( ty1, ty2 ) );
+
+		if ( tNear > tFar || tFar < 0.0f || tNear > 1.0f ) return false;
+
+		fEnter	= std::max( tNear, 0.0f );
+		fExit	= std::min( tFar, 1.0f );
+		return true;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : SweepBullets () (Static)
+// Desc : Batched ray / slab test of every bullet against one target. Motion
+//		is taken relative to the target, which then stands still.
+//-----------------------------------------------------------------------------
+int CSweptCollision::SweepBullets( const float* pX, const float* pY, const float* pDX, const float* pDY, int nCount,
+								   float fHalfW, float fHalfH, const Box& Target, float* pEnter, float* pExit )
+{
+	float fMinX = Target.x - Target.fHalfW - fHalfW;
+	float fMaxX = Target.x + Target.fHalfW + fHalfW;
+	float fMinY = Target.y - Target.fHalfH - fHalfH;
+	float fMaxY = Target.y + Target.fHalfH + fHalfH;
+
+	int nHits = 0;
+	int i = 0;
+
+#ifdef SWEPT_SSE2
+	const __m128 MinX = _mm_set1_ps( fMinX ), MaxX = _mm_set1_ps( fMaxX );
+	const __m128 MinY = _mm_set1_ps( fMinY ), MaxY = _mm_set1_ps( fMaxY );
+	const __m128 TDX  = _mm_set1_ps( Target.dx ), TDY = _mm_set1_ps( Target.dy );
+	const __m128 Zero = _mm_setzero_ps(), One = _mm_set1_ps( 1.0f );
+	const __m128 Huge = _mm_set1_ps( HUGE_INV ), Miss = _mm_set1_ps( NO_HIT );
+
+	for ( ; i + 4 <= nCount; i += 4 )
+	{
+		__m128 px = _mm_loadu_ps( pX + i ), py = _mm_loadu_ps( pY + i );
+		__m128 dx = _mm_sub_ps( _mm_loadu_ps( pDX + i ), TDX );
+		__m128 dy = _mm_sub_ps( _mm_loadu_ps( pDY + i ), TDY );
+
+		// 1/d with zero motion replaced by HUGE_INV
+		__m128 zx = _mm_cmpeq_ps( dx, Zero ), zy = _mm_cmpeq_ps( dy, Zero );
+		__m128 ix = _mm_or_ps( _mm_and_ps( zx, Huge ), _mm_andnot_ps( zx, _mm_div_ps( One, dx ) ) );
+		__m128 iy = _mm_or_ps( _mm_and_ps( zy, Huge ), _mm_andnot_ps( zy, _mm_div_ps( One, dy ) ) );
+
+		__m128 tx1 = _mm_mul_ps( _mm_sub_ps( MinX, px ), ix ), tx2 = _mm_mul_ps( _mm_sub_ps( MaxX, px ), ix );
+		__m128 ty1 = _mm_mul_ps( _mm_sub_ps( MinY, py ), iy ), ty2 = _mm_mul_ps( _mm_sub_ps( MaxY, py ), iy );
+
+		__m128 tNear = _mm_max_ps( _mm_min_ps( tx1, tx2 ), _mm_min_ps( ty1, ty2 ) );
+		__m128 tFar	 = _mm_min_ps( _mm_max_ps( tx1, tx2 ), _mm_max_ps( ty1, ty2 ) );
+
+		__m128 Hit = _mm_and_ps( _mm_cmple_ps( tNear, tFar ), _mm_and_ps( _mm_cmpge_ps( tFar, Zero ), _mm_cmple_ps( tNear, One ) ) );
+
+		_mm_storeu_ps( pEnter + i, _mm_or_ps( _mm_and_ps( Hit, _mm_max_ps( tNear, Zero ) ), _mm_andnot_ps( Hit, Miss ) ) );
+		_mm_storeu_ps( pExit + i,  _mm_min_ps( tFar, One ) );
+
+		int nMask = _mm_movemask_ps( Hit );
+		nHits += ( nMask & 1 ) + ( ( nMask >> 1 ) & 1 ) + ( ( nMask >> 2 ) & 1 ) + ( ( nMask >> 3 ) & 1 );
+	}
+#endif
+
+	for ( ; i < nCount; ++i )
+	{
+		if ( RayBox( pX[i], pY[i], pDX[i] - Target.dx, pDY[i] - Target.dy, fMinX, fMinY, fMaxX, fMaxY, pEnter[i], pExit[i] ) )
+			++nHits;
+		else
+			pEnter[i] = NO_HIT;
+	}
+
+	return nHits;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SweepBox () (Static)
+// Desc : Single pair version, true if A and B touch during the tick.
+//-----------------------------------------------------------------------------
+bool CSweptCollision::SweepBox( const Box& A, const Box& B, float& fEnter, float& fExit )
+{
+	return RayBox( A.x, A.y, A.dx - B.dx, A.dy - B.dy,
+				   B.x - B.fHalfW - A.fHalfW, B.y - B.fHalfH - A.fHalfH,
+				   B.x + B.fHalfW + A.fHalfW, B.y + B.fHalfH + A.fHalfH, fEnter, fExit );
+}
@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// File: CSweptCollision.h
+//
+// Desc: Continuous collision for fast moving boxes. Each bullet's motion over
+//	   a tick is swept against a target box (moving as well), giving the
+//	   fraction of the tick at which they first touch, so hits are not lost
+//	   however far a bullet travels per tick. Four bullets per SSE2 step.
+//-----------------------------------------------------------------------------
+
+#ifndef _CSWEPTCOLLISION_H_
+#define _CSWEPTCOLLISION_H_
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSweptCollision (Class)
+// Desc : Stateless swept AABB tests. The target is grown by the bullet's
+//		half extents (Minkowski sum), turning each test into a ray against
+//		a box in the target's frame.
+//-----------------------------------------------------------------------------
+class CSweptCollision
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	static const float		NO_HIT;				// Entry time of a bullet that misses
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Box
+	{
+		float				x, y;				// Centre at the start of the tick
+		float				fHalfW, fHalfH;
+		float				dx, dy;				// Motion over the tick
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class.
+	//-------------------------------------------------------------------------
+	// Bullets are given as arrays (centres and motion over the tick), all
+	// with the same half extents. pEnter / pExit receive the hit interval
+	// as fractions of the tick, pEnter is NO_HIT for a miss. Returns the
+	// number of bullets that hit.
+	static int				SweepBullets( const float* pX, const float* pY, const float* pDX, const float* pDY, int nCount,
+										  float fHalfW, float fHalfH, const Box& Target, float* pEnter, float* pExit );
+
+	static bool				SweepBox( const Box& A, const Box& B, float& fEnter, float& fExit );
+};
+
+#endif // _CSWEPTCOLLISION_H_
@@ -0,0 +1,219 @@
+//-----------------------------------------------------------------------------
+// File: CTelemetry.cpp
+//
+// Desc: Resource telemetry. Live heap allocations and bytes are counted per
+//	   subsystem (the thread's current Scope tags each allocation), handles
+//	   owned by the engine are counted where they are created / destroyed,
+//	   and process wide GDI, USER, kernel handle and memory figures are read
+//	   on Capture. Samples can be written out once per frame as CSV.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTelemetry Specific Includes
+//-----------------------------------------------------------------------------
+#include "CTelemetry.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <psapi.h>
+
+#pragma comment( lib, "psapi.lib" )
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+namespace
+{
+	const char* const				SUBSYSTEM_NAMES[CTelemetry::SUB_COUNT] = { "general", "assets", "graphics", "entities", "ai" };
+
+	std::atomic<LONGLONG>			g_nAllocs[CTelemetry::SUB_COUNT];
+	std::atomic<LONGLONG>			g_nBytes[CTelemetry::SUB_COUNT];
+	std::atomic<LONGLONG>			g_nHandles[CTelemetry::SUB_COUNT];
+	thread_local CTelemetry::SUBSYSTEM g_eCurrent = CTelemetry::SUB_GENERAL;
+
+#ifndef NO_MEMORY_TELEMETRY
+	// Put in front of every block so the free is charged to the subsystem
+	// that made the allocation, whichever thread releases it
+	struct alignas(16) BlockHeader
+	{
+		size_t						nSize;
+		int							nSubsystem;
+	};
+
+	void* TrackedAlloc( size_t nSize )
+	{
+		BlockHeader* pHeader = (BlockHeader*)malloc( sizeof(BlockHeader) + nSize );
+		if ( !pHeader ) return NULL;
+
+		pHeader->nSize		= nSize;
+		pHeader->nSubsystem	= g_eCurrent;
+		g_nAllocs[g_eCurrent].fetch_add( 1, std::memory_order_relaxed );
+		g_nBytes[g_eCurrent].fetch_add( (LONGLONG)nSize, std::memory_order_relaxed );
+		return pHeader + 1;
+	}
+
+	void TrackedFree( void* p )
+	{
+		if ( !p ) return;
+
+		BlockHeader* pHeader = (BlockHeader*)p - 1;
+		g_nAllocs[pHeader->nSubsystem].fetch_sub( 1, std::memory_order_relaxed );
+		g_nBytes[pHeader->nSubsystem].fetch_sub( (LONGLONG)pHeader->nSize, std::memory_order_relaxed );
+		free( pHeader );
+	}
+#endif
+}
+
+#ifndef NO_MEMORY_TELEMETRY
+//-----------------------------------------------------------------------------
+// Global Allocation Operators
+// Desc : Replace the standard ones for the whole program. The nothrow and
+//		sized forms default to these.
+//-----------------------------------------------------------------------------
+void* operator new( size_t nSize )
+{
+	void* p = TrackedAlloc( nSize );
+	if ( !p ) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[]( size_t nSize )
+{
+	void* p = TrackedAlloc( nSize );
+	if ( !p ) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete( void* p ) noexcept			{ TrackedFree( p ); }
+void operator delete[]( void* p ) noexcept			{ TrackedFree( p ); }
+void operator delete( void* p, size_t ) noexcept	{ TrackedFree( p ); }
+void operator delete[]( void* p, size_t ) noexcept	{ TrackedFree( p ); }
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : Scope () (Constructor)
+// Desc : Makes eSubsystem the calling thread's allocation tag.
+//-----------------------------------------------------------------------------
+CTelemetry::Scope::Scope( SUBSYSTEM eSubsystem )
+{
+	m_ePrevious	= g_eCurrent;
+	g_eCurrent	= eSubsystem;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~Scope () (Destructor)
+// Desc : Restores the tag that was current before.
+//-----------------------------------------------------------------------------
+CTelemetry::Scope::~Scope()
+{
+	g_eCurrent = m_ePrevious;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CTelemetry () (Constructor)
+// Desc : CTelemetry Class Constructor
+//-----------------------------------------------------------------------------
+CTelemetry::CTelemetry()
+{
+	m_pLog = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CTelemetry () (Destructor)
+// Desc : CTelemetry Class Destructor
+//-----------------------------------------------------------------------------
+CTelemetry::~CTelemetry()
+{
+	CloseLog();
+}
+
+//-----------------------------------------------------------------------------
+// Name : TrackHandles () (Static)
+// Desc : Records nDelta handles created (positive) or closed (negative).
+//-----------------------------------------------------------------------------
+void CTelemetry::TrackHandles( SUBSYSTEM eSubsystem, int nDelta )
+{
+	g_nHandles[eSubsystem].fetch_add( nDelta, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Capture () (Static)
+// Desc : Reads every counter plus the process wide figures.
+//-----------------------------------------------------------------------------
+void CTelemetry::Capture( Sample& Out, ULONG nFrame )
+{
+	Out.nFrame = nFrame;
+	for ( int i = 0; i < SUB_COUNT; ++i )
+	{
+		Out.Sub[i].nAllocs	= g_nAllocs[i].load( std::memory_order_relaxed );
+		Out.Sub[i].nBytes	= g_nBytes[i].load( std::memory_order_relaxed );
+		Out.Sub[i].nHandles	= g_nHandles[i].load( std::memory_order_relaxed );
+	}
+
+	HANDLE hProcess = GetCurrentProcess();
+	DWORD  dwHandles = 0;
+	GetProcessHandleCount( hProcess, &dwHandles );
+	Out.nGdiObjects		= GetGuiResources( hProcess, GR_GDIOBJECTS );
+	Out.nUserObjects	= GetGuiResources( hProcess, GR_USEROBJECTS );
+	Out.nKernelHandles	= dwHandles;
+
+	PROCESS_MEMORY_COUNTERS_EX Memory;
+	Memory.cb = sizeof(Memory);
+	if ( GetProcessMemoryInfo( hProcess, (PROCESS_MEMORY_COUNTERS*)&Memory, sizeof(Memory) ) )
+	{
+		Out.nWorkingSet		= Memory.WorkingSetSize;
+		Out.nPrivateBytes	= Memory.PrivateUsage;
+	}
+	else
+		Out.nWorkingSet = Out.nPrivateBytes = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetName () (Static)
+// Desc : Short name used in the CSV header.
+//-----------------------------------------------------------------------------
+const char* CTelemetry::GetName( SUBSYSTEM eSubsystem )
+{
+	return SUBSYSTEM_NAMES[eSubsystem];
+}
+
+//-----------------------------------------------------------------------------
+// Name : OpenLog ()
+// Desc : Starts a CSV file, one row per WriteSample.
+//-----------------------------------------------------------------------------
+bool CTelemetry::OpenLog( const char* szPath )
+{
+	CloseLog();
+
+	if ( fopen_s( &m_pLog, szPath, "w" ) != 0 ) { m_pLog = NULL; return false; }
+
+	fprintf( m_pLog, "frame" );
+	for ( int i = 0; i < SUB_COUNT; ++i )
+		fprintf( m_pLog, ",%s_allocs,%s_bytes,%s_handles", SUBSYSTEM_NAMES[i], SUBSYSTEM_NAMES[i], SUBSYSTEM_NAMES[i] );
+	fprintf( m_pLog, ",gdi_objects,user_objects,kernel_handles,working_set,private_bytes\n" );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CloseLog ()
+// Desc : Flushes and closes the CSV file.
+//-----------------------------------------------------------------------------
+void CTelemetry::CloseLog()
+{
+	if ( m_pLog ) fclose( m_pLog );
+	m_pLog = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteSample ()
+// Desc : Appends one row. Buffered by the CRT, cheap enough per frame.
+//-----------------------------------------------------------------------------
+void CTelemetry::WriteSample( const Sample& In )
+{
+	if ( !m_pLog ) return;
+
+	fprintf( m_pLog, "%lu", In.nFrame );
+	for ( int i = 0; i < SUB_COUNT; ++i )
+		fprintf( m_pLog, ",%lld,%lld,%lld", In.Sub[i].nAllocs, In.Sub[i].nBytes, In.Sub[i].nHandles );
+	fprintf( m_pLog, ",%lu,%lu,%lu,%llu,%llu\n", In.nGdiObjects, In.nUserObjects, In.nKernelHandles, In.nWorkingSet, In.nPrivateBytes );
+}
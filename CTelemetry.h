@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// File: CTelemetry.h
+//
+// Desc: Resource telemetry. Live heap allocations and bytes are counted per
+//	   subsystem (the thread's current Scope tags each allocation), handles
+//	   owned by the engine are counted where they are created / destroyed,
+//	   and process wide GDI, USER, kernel handle and memory figures are read
+//	   on Capture. Samples can be written out once per frame as CSV.
+//-----------------------------------------------------------------------------
+
+#ifndef _CTELEMETRY_H_
+#define _CTELEMETRY_H_
+
+//-----------------------------------------------------------------------------
+// CTelemetry Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <cstdio>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTelemetry (Class)
+// Desc : Counters are process wide statics (the global operator new feeds
+//		them); an instance only owns the per frame CSV export. Define
+//		NO_MEMORY_TELEMETRY to leave operator new alone, heap counters then
+//		stay at zero.
+//-----------------------------------------------------------------------------
+class CTelemetry
+{
+public:
+	//-------------------------------------------------------------------------
+	// Enumerators
+	//-------------------------------------------------------------------------
+	enum SUBSYSTEM
+	{
+		SUB_GENERAL,			// Anything not in a Scope
+		SUB_ASSETS,				// Pack, decoding, load batch
+		SUB_GRAPHICS,			// Atlas, background, masks, render queue, compositor
+		SUB_ENTITIES,			// Players, sprites, bullets, kinematics
+		SUB_AI,					// Flow field, CPU opponents
+		SUB_COUNT
+	};
+
+	//-------------------------------------------------------------------------
+	// Public Structures
+	//-------------------------------------------------------------------------
+	struct Counters
+	{
+		LONGLONG			nAllocs;			// Live heap blocks
+		LONGLONG			nBytes;				// Live heap bytes
+		LONGLONG			nHandles;			// Live GDI / file / event handles
+	};
+
+	struct Sample
+	{
+		ULONG				nFrame;
+		Counters			Sub[SUB_COUNT];
+		ULONG				nGdiObjects;		// Whole process
+		ULONG				nUserObjects;
+		ULONG				nKernelHandles;
+		ULONGLONG			nWorkingSet;		// Bytes
+		ULONGLONG			nPrivateBytes;
+	};
+
+	//-------------------------------------------------------------------------
+	// Name : Scope (Class)
+	// Desc : Tags the heap allocations the current thread makes while it is
+	//		alive. Nests, the previous tag comes back on destruction.
+	//-------------------------------------------------------------------------
+	class Scope
+	{
+	public:
+		explicit			 Scope( SUBSYSTEM eSubsystem );
+							~Scope( );
+	private:
+		SUBSYSTEM			m_ePrevious;
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CTelemetry();
+	virtual ~CTelemetry();
+
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class.
+	//-------------------------------------------------------------------------
+	static void				TrackHandles( SUBSYSTEM eSubsystem, int nDelta );
+	static void				Capture( Sample& Out, ULONG nFrame );
+	static const char*		GetName( SUBSYSTEM eSubsystem );
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					OpenLog( const char* szPath );
+	void					CloseLog( );
+	bool					IsLogging( ) const { return m_pLog != NULL; }
+	void					WriteSample( const Sample& In );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	FILE*					m_pLog;
+};
+
+#endif // _CTELEMETRY_H_
@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+// File: CThreadPool.cpp
+//
+// Desc: Small fixed size worker pool used to run background jobs (flow field
+//	   rebuilds, asset loading, ...) off the main game thread.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CThreadPool Specific Includes
+//-----------------------------------------------------------------------------
+#include "CThreadPool.h"
+
+//-----------------------------------------------------------------------------
+// Name : CThreadPool () (Constructor)
+// Desc : CThreadPool Class Constructor
+//-----------------------------------------------------------------------------
+CThreadPool::CThreadPool()
+{
+	m_nRunning	= 0;
+	m_bQuit		= false;
+
+	for ( Batch& b : m_Batches )
+	{
+		b.bBusy		= false;
+		b.bOpen		= false;
+		b.nUsers	= 0;
+		b.nNext		= 0;
+		b.nDone		= 0;
+		b.nCount	= 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CThreadPool () (Destructor)
+// Desc : CThreadPool Class Destructor
+//-----------------------------------------------------------------------------
+CThreadPool::~CThreadPool()
+{
+	Stop();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Start ()
+// Desc : Spawns the worker threads. Passing 0 uses one worker per hardware
+//		thread, leaving one for the game thread.
+//-----------------------------------------------------------------------------
+bool CThreadPool::Start( unsigned int nThreads )
+{
+	if ( !m_Threads.empty() ) return true;
+
+	if ( nThreads == 0 )
+	{
+		nThreads = std::thread::hardware_concurrency();
+		nThreads = ( nThreads > 1 ) ? nThreads - 1 : 1;
+	}
+
+	m_bQuit = false;
+	for ( unsigned int i = 0; i < nThreads; ++i )
+		m_Threads.push_back( std::thread( &CThreadPool::WorkerProc, this ) );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Stop ()
+// Desc : Finishes any queued jobs and joins the worker threads.
+//-----------------------------------------------------------------------------
+void CThreadPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+		m_bQuit = true;
+	}
+	m_cvJob.notify_all();
+
+	for ( size_t i = 0; i < m_Threads.size(); ++i )
+		m_Threads[i].join();
+	m_Threads.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Submit ()
+// Desc : Queues a job. If the pool was never started the job runs inline.
+//-----------------------------------------------------------------------------
+void CThreadPool::Submit( const std::function<void()>& Job )
+{
+	if ( m_Threads.empty() ) { Job(); return; }
+
+	{
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+		m_Jobs.push_back( Job );
+	}
+	m_cvJob.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitIdle ()
+// Desc : Blocks until every queued job has finished executing.
+//-----------------------------------------------------------------------------
+void CThreadPool::WaitIdle()
+{
+	std::unique_lock<std::mutex> Lock( m_Mutex );
+	m_cvIdle.wait( Lock, [this] { return m_Jobs.empty() && m_nRunning == 0; } );
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunBatch () (Private)
+// Desc : ParallelFor body. Publishes the range in a free slot, wakes the
+//		workers and drains it alongside them; returns once every index is
+//		done and no helper still looks at the slot. Without workers or a
+//		free slot the range simply runs on the calling thread.
+//-----------------------------------------------------------------------------
+void CThreadPool::RunBatch( int nCount, const BodyRef& Body )
+{
+	if ( nCount <= 0 ) return;
+
+	Batch* pBatch = NULL;
+	if ( !m_Threads.empty() && nCount > 1 )
+	{
+		for ( Batch& b : m_Batches )
+		{
+			bool bFree = false;
+			if ( b.bBusy.compare_exchange_strong( bFree, true ) ) { pBatch = &b; break; }
+		}
+	}
+
+	if ( !pBatch )
+	{
+		for ( int i = 0; i < nCount; ++i ) Body.pfnCall( Body.pBody, i );
+		return;
+	}
+
+	pBatch->nCount	= nCount;
+	pBatch->Body	= Body;
+	pBatch->nNext	= 0;
+	pBatch->nDone	= 0;
+	{
+		// Under the queue lock so a worker can not miss the wake up
+		std::lock_guard<std::mutex> Lock( m_Mutex );
+		pBatch->bOpen = true;
+	}
+	m_cvJob.notify_all();
+
+	DrainBatch( *pBatch );
+
+	{
+		std::unique_lock<std::mutex> Lock( pBatch->Mutex );
+		pBatch->cvDone.wait( Lock, [&] { return pBatch->nDone.load() == nCount; } );
+	}
+
+	// Helpers that got in late only find an exhausted range, let them leave
+	pBatch->bOpen = false;
+	while ( pBatch->nUsers.load() != 0 ) std::this_thread::yield();
+	pBatch->bBusy = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : HasBatchWork () (Private)
+// Desc : Is any open batch still handing out indices ?
+//-----------------------------------------------------------------------------
+bool CThreadPool::HasBatchWork() const
+{
+	for ( const Batch& b : m_Batches )
+		if ( b.bOpen.load() && b.nNext.load() < b.nCount ) return true;
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : HelpBatches () (Private)
+// Desc : Worker side of ParallelFor, drains every open batch it finds.
+//		nUsers is raised before bOpen is checked again, so the owner can not
+//		release the slot while this thread is still reading it.
+//-----------------------------------------------------------------------------
+void CThreadPool::HelpBatches()
+{
+	for ( Batch& b : m_Batches )
+	{
+		if ( !b.bOpen.load() ) continue;
+
+		b.nUsers.fetch_add( 1 );
+		if ( b.bOpen.load() ) DrainBatch( b );
+		b.nUsers.fetch_sub( 1 );
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrainBatch () (Private, Static)
+// Desc : Takes indices from the batch until none are left, waking the owner
+//		after the last one completes.
+//-----------------------------------------------------------------------------
+void CThreadPool::DrainBatch( Batch& b )
+{
+	for (;;)
+	{
+		int i = b.nNext.fetch_add( 1 );
+		if ( i >= b.nCount ) return;
+		b.Body.pfnCall( b.Body.pBody, i );
+		if ( b.nDone.fetch_add( 1 ) + 1 == b.nCount )
+		{
+			std::lock_guard<std::mutex> Lock( b.Mutex );
+			b.cvDone.notify_all();
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetThreadCount ()
+// Desc : Number of worker threads owned by the pool.
+//-----------------------------------------------------------------------------
+unsigned int CThreadPool::GetThreadCount() const
+{
+	return (unsigned int)m_Threads.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : WorkerProc () (Private)
+// Desc : Worker thread body, pops and runs jobs until the pool is stopped.
+//-----------------------------------------------------------------------------
+void CThreadPool::WorkerProc()
+{
+	for (;;)
+	{
+		std::function<void()> Job;
+		{
+			std::unique_lock<std::mutex> Lock( m_Mutex );
+			m_cvJob.wait( Lock, [this] { return m_bQuit || !m_Jobs.empty() || HasBatchWork(); } );
+
+			// ParallelFor ranges first, their callers are blocked on them
+			if ( HasBatchWork() )
+			{
+				Lock.unlock();
+				HelpBatches();
+				continue;
+			}
+			if ( m_Jobs.empty() ) return;
+
+			Job = m_Jobs.front();
+			m_Jobs.pop_front();
+			++m_nRunning;
+		}
+
+		Job();
+
+		{
+			std::lock_guard<std::mutex> Lock( m_Mutex );
+			--m_nRunning;
+			if ( m_Jobs.empty() && m_nRunning == 0 ) m_cvIdle.notify_all();
+		}
+	}
+}
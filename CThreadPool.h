@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------
+// File: CThreadPool.h
+//
+// Desc: Small fixed size worker pool used to run background jobs (flow field
+//	   rebuilds, asset loading, ...) off the main game thread.
+//-----------------------------------------------------------------------------
+
+#ifndef _CTHREADPOOL_H_
+#define _CTHREADPOOL_H_
+
+//-----------------------------------------------------------------------------
+// CThreadPool Specific Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CThreadPool (Class)
+// Desc : Runs submitted jobs on a set of worker threads in FIFO order.
+//		ParallelFor does not allocate: it borrows the caller's body and one
+//		of a fixed set of batch slots that idle workers pick up directly.
+//-----------------------------------------------------------------------------
+class CThreadPool
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum
+	{
+		MAX_BATCHES		= 8,		// ParallelFor calls in flight, more run inline
+	};
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CThreadPool();
+	virtual ~CThreadPool();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Start( unsigned int nThreads = 0 );
+	void					Stop( );
+	void					Submit( const std::function<void()>& Job );
+	void					WaitIdle( );
+	unsigned int			GetThreadCount( ) const;
+
+	//-------------------------------------------------------------------------
+	// Name : ParallelFor ()
+	// Desc : Calls Body(i) for every i in [0, nCount) spread over the workers.
+	//		Body is called in place, never copied, so any callable works and
+	//		nothing is allocated.
+	//-------------------------------------------------------------------------
+	template <typename BODY>
+	void					ParallelFor( int nCount, const BODY& Body )
+	{
+		BodyRef Ref;
+		Ref.pBody	= &Body;
+		Ref.pfnCall	= []( const void* pBody, int i ) { ( *(const BODY*)pBody )( i ); };
+		RunBatch( nCount, Ref );
+	}
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Structures
+	//-------------------------------------------------------------------------
+	struct BodyRef						// Non owning view of a ParallelFor body
+	{
+		const void*			pBody;
+		void				( *pfnCall )( const void* pBody, int i );
+	};
+
+	struct Batch
+	{
+		std::atomic<bool>		bBusy;		// Slot owned by a ParallelFor call
+		std::atomic<bool>		bOpen;		// Fields below are valid for helpers
+		std::atomic<int>		nUsers;		// Helpers inside the slot right now
+		std::atomic<int>		nNext;
+		std::atomic<int>		nDone;
+		std::atomic<int>		nCount;
+		BodyRef					Body;
+		std::mutex				Mutex;
+		std::condition_variable	cvDone;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					WorkerProc( );
+	void					RunBatch( int nCount, const BodyRef& Body );
+	bool					HasBatchWork( ) const;
+	void					HelpBatches( );
+	static void				DrainBatch( Batch& b );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	std::vector<std::thread>			m_Threads;		// Worker threads
+	std::deque<std::function<void()>>	m_Jobs;			// Pending jobs
+	std::mutex							m_Mutex;		// Guards the job queue
+	std::condition_variable				m_cvJob;		// Signalled when a job is queued
+	std::condition_variable				m_cvIdle;		// Signalled when the pool drains
+	unsigned int						m_nRunning;		// Jobs currently executing
+	bool								m_bQuit;		// Workers should exit
+	Batch								m_Batches[MAX_BATCHES];	// ParallelFor slots, never reallocated
+};
+
+#endif // _CTHREADPOOL_H_
@@ -0,0 +1,216 @@
+//-----------------------------------------------------------------------------
+// File: CTileCompositor.cpp
+//
+// Desc: Multi threaded software compositor. The frame buffer is split into
+//	   tiles, atlas draw commands are binned to the tiles they overlap and
+//	   each tile is rasterised on a pool worker in queue order, so output is
+//	   pixel identical to a single threaded pass.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTileCompositor Specific Includes
+//-----------------------------------------------------------------------------
+#include "CTileCompositor.h"
+#include "CTelemetry.h"
+#include <algorithm>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// Name : CTileCompositor () (Constructor)
+// Desc : CTileCompositor Class Constructor
+//-----------------------------------------------------------------------------
+CTileCompositor::CTileCompositor()
+{
+	m_pPool				= NULL;
+	m_bSingleThreaded	= false;
+	m_hDC				= NULL;
+	m_hBitmap			= NULL;
+	m_hOldBitmap		= NULL;
+	m_pPixels			= NULL;
+	m_nWidth			= 0;
+	m_nHeight			= 0;
+	m_nTilesX			= 0;
+	m_nTilesY			= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CTileCompositor () (Destructor)
+// Desc : CTileCompositor Class Destructor
+//-----------------------------------------------------------------------------
+CTileCompositor::~CTileCompositor()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init ()
+// Desc : Creates the nWidth x nHeight frame buffer and the tile grid.
+//-----------------------------------------------------------------------------
+bool CTileCompositor::Init( HDC hdcRef, int nWidth, int nHeight, CThreadPool* pPool )
+{
+	Release();
+	if ( nWidth <= 0 || nHeight <= 0 ) return false;
+
+	BITMAPINFO bmi;
+	memset( &bmi, 0, sizeof(bmi) );
+	bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		= nWidth;
+	bmi.bmiHeader.biHeight		= -nHeight;		// Top down
+	bmi.bmiHeader.biPlanes		= 1;
+	bmi.bmiHeader.biBitCount	= 32;
+	bmi.bmiHeader.biCompression	= BI_RGB;
+
+	void* pBits = NULL;
+	m_hBitmap = CreateDIBSection( hdcRef, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0 );
+	if ( !m_hBitmap ) return false;
+
+	m_hDC			= CreateCompatibleDC( hdcRef );
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, 1 + ( m_hDC != NULL ) );
+	m_hOldBitmap	= SelectObject( m_hDC, m_hBitmap );
+	m_pPixels		= (ULONG*)pBits;
+	m_nWidth		= nWidth;
+	m_nHeight		= nHeight;
+	m_pPool			= pPool;
+
+	m_nTilesX		= ( nWidth  + TILE_SIZE - 1 ) / TILE_SIZE;
+	m_nTilesY		= ( nHeight + TILE_SIZE - 1 ) / TILE_SIZE;
+	m_Bins.resize( m_nTilesX * m_nTilesY );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the frame buffer.
+//-----------------------------------------------------------------------------
+void CTileCompositor::Release()
+{
+	if ( m_hDC )
+	{
+		SelectObject( m_hDC, m_hOldBitmap );
+		DeleteDC( m_hDC );
+	}
+	if ( m_hBitmap ) DeleteObject( m_hBitmap );
+	CTelemetry::TrackHandles( CTelemetry::SUB_GRAPHICS, -( ( m_hDC != NULL ) + ( m_hBitmap != NULL ) ) );
+
+	m_hDC		= NULL;
+	m_hBitmap	= NULL;
+	m_pPixels	= NULL;
+	m_Bins.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Compose ()
+// Desc : Composites a sorted queue and copies the result to hdcDest. Runs of
+//		atlas commands are rasterised in parallel; anything else (background
+//		image, sprites without an atlas entry) is drawn with GDI in between,
+//		so queue order is preserved exactly.
+//-----------------------------------------------------------------------------
+void CTileCompositor::Compose( const CRenderQueue& Queue, const CSpriteAtlas& Atlas, HDC hdcDest )
+{
+	const std::vector<RenderCommand>& Commands = Queue.GetCommands();
+	bool bSoftware = Atlas.GetPixels() != NULL;
+
+	Clear();
+
+	int nStart = 0;
+	for ( int i = 0; i < (int)Commands.size(); ++i )
+	{
+		if ( bSoftware && CRenderQueue::GetTexture( Commands[i] ) == CRenderQueue::TEXTURE_ATLAS ) continue;
+
+		if ( i > nStart ) FlushTiles( &Commands[nStart], i - nStart, Atlas );
+		CRenderQueue::ExecuteCommand( m_hDC, Atlas, Commands[i] );
+		nStart = i + 1;
+	}
+	if ( (int)Commands.size() > nStart ) FlushTiles( &Commands[nStart], (int)Commands.size() - nStart, Atlas );
+
+	GdiFlush();
+	BitBlt( hdcDest, 0, 0, m_nWidth, m_nHeight, m_hDC, 0, 0, SRCCOPY );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear () (Private)
+// Desc : Fills the frame buffer white, matching BackBuffer::reset.
+//-----------------------------------------------------------------------------
+void CTileCompositor::Clear()
+{
+	std::fill( m_pPixels, m_pPixels + (size_t)m_nWidth * m_nHeight, 0x00FFFFFF );
+}
+
+//-----------------------------------------------------------------------------
+// Name : FlushTiles () (Private)
+// Desc : Bins a run of atlas commands to tiles and rasterises every tile.
+//-----------------------------------------------------------------------------
+void CTileCompositor::FlushTiles( const RenderCommand* pCommands, int nCount, const CSpriteAtlas& Atlas )
+{
+	// GDI may still be writing into the DIB section
+	GdiFlush();
+
+	for ( size_t i = 0; i < m_Bins.size(); ++i ) m_Bins[i].clear();
+
+	for ( int i = 0; i < nCount; ++i )
+	{
+		const RenderCommand& Cmd = pCommands[i];
+		const RECT& rc = Atlas.GetRect( Cmd.nRegion );
+		int x0 = Cmd.x - ( rc.right - rc.left ) / 2;
+		int y0 = Cmd.y - ( rc.bottom - rc.top ) / 2;
+		int x1 = x0 + ( rc.right - rc.left );
+		int y1 = y0 + ( rc.bottom - rc.top );
+
+		x0 = std::max( x0, 0 );	x1 = std::min( x1, m_nWidth );
+		y0 = std::max( y0, 0 );	y1 = std::min( y1, m_nHeight );
+		if ( x0 >= x1 || y0 >= y1 ) continue;
+
+		for ( int ty = y0 / TILE_SIZE; ty <= ( y1 - 1 ) / TILE_SIZE; ++ty )
+			for ( int tx = x0 / TILE_SIZE; tx <= ( x1 - 1 ) / TILE_SIZE; ++tx )
+				m_Bins[ ty * m_nTilesX + tx ].push_back( i );
+	}
+
+	int nTiles = m_nTilesX * m_nTilesY;
+	auto Raster = [&]( int nTile ) { RasterTile( nTile, pCommands, Atlas ); };
+
+	if ( m_pPool && !m_bSingleThreaded ) m_pPool->ParallelFor( nTiles, Raster );
+	else for ( int t = 0; t < nTiles; ++t ) Raster( t );
+}
+
+//-----------------------------------------------------------------------------
+// Name : RasterTile () (Private)
+// Desc : Draws the tile's binned commands in queue order, clipped to the
+//		tile. Tiles never overlap so workers need no synchronisation.
+//-----------------------------------------------------------------------------
+void CTileCompositor::RasterTile( int nTile, const RenderCommand* pCommands, const CSpriteAtlas& Atlas )
+{
+	const std::vector<int>& Bin = m_Bins[nTile];
+	if ( Bin.empty() ) return;
+
+	int tx0 = ( nTile % m_nTilesX ) * TILE_SIZE;
+	int ty0 = ( nTile / m_nTilesX ) * TILE_SIZE;
+	int tx1 = std::min( tx0 + (int)TILE_SIZE, m_nWidth );
+	int ty1 = std::min( ty0 + (int)TILE_SIZE, m_nHeight );
+
+	const ULONG* pAtlas	= Atlas.GetPixels();
+	int			 nPitch	= Atlas.GetWidth();
+
+	for ( size_t i = 0; i < Bin.size(); ++i )
+	{
+		const RenderCommand& Cmd = pCommands[ Bin[i] ];
+		const RECT& rc = Atlas.GetRect( Cmd.nRegion );
+		int w  = rc.right - rc.left;
+		int h  = rc.bottom - rc.top;
+		int dx = Cmd.x - w / 2;
+		int dy = Cmd.y - h / 2;
+
+		int x0 = std::max( dx, tx0 ), x1 = std::min( dx + w, tx1 );
+		int y0 = std::max( dy, ty0 ), y1 = std::min( dy + h, ty1 );
+
+		for ( int y = y0; y < y1; ++y )
+		{
+			const ULONG* pSrc = pAtlas + (size_t)( rc.top + y - dy ) * nPitch + rc.left + ( x0 - dx );
+			ULONG*		 pDst = m_pPixels + (size_t)y * m_nWidth + x0;
+
+			// Same result as the SRCAND / SRCPAINT pair with a 1 bit mask
+			for ( int x = x0; x < x1; ++x, ++pSrc, ++pDst )
+				if ( *pSrc & 0xFF000000 ) *pDst = *pSrc & 0x00FFFFFF;
+		}
+	}
+}
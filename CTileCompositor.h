@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// File: CTileCompositor.h
+//
+// Desc: Multi threaded software compositor. The frame buffer is split into
+//	   tiles, atlas draw commands are binned to the tiles they overlap and
+//	   each tile is rasterised on a pool worker in queue order, so output is
+//	   pixel identical to a single threaded pass.
+//-----------------------------------------------------------------------------
+
+#ifndef _CTILECOMPOSITOR_H_
+#define _CTILECOMPOSITOR_H_
+
+//-----------------------------------------------------------------------------
+// CTileCompositor Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CRenderQueue.h"
+#include "CSpriteAtlas.h"
+#include "CThreadPool.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTileCompositor (Class)
+// Desc : Owns a 32 bit DIB section frame buffer and composites render queues
+//		into it before handing the result to the back buffer.
+//-----------------------------------------------------------------------------
+class CTileCompositor
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constants
+	//-------------------------------------------------------------------------
+	enum { TILE_SIZE = 128 };
+
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CTileCompositor();
+	virtual ~CTileCompositor();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class.
+	//-------------------------------------------------------------------------
+	bool					Init( HDC hdcRef, int nWidth, int nHeight, CThreadPool* pPool );
+	void					Release( );
+	bool					IsReady( ) const { return m_hDC != NULL; }
+	void					SetSingleThreaded( bool bSingle ) { m_bSingleThreaded = bSingle; }
+
+	void					Compose( const CRenderQueue& Queue, const CSpriteAtlas& Atlas, HDC hdcDest );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	void					Clear( );
+	void					FlushTiles( const RenderCommand* pCommands, int nCount, const CSpriteAtlas& Atlas );
+	void					RasterTile( int nTile, const RenderCommand* pCommands, const CSpriteAtlas& Atlas );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	CThreadPool*			m_pPool;
+	bool					m_bSingleThreaded;		// Rasterise tiles inline, for comparisons
+
+	HDC						m_hDC;					// Frame buffer DC, used for GDI fallbacks
+	HBITMAP					m_hBitmap;
+	HGDIOBJ					m_hOldBitmap;
+	ULONG*					m_pPixels;				// Top down 0x00RRGGBB
+	int						m_nWidth;
+	int						m_nHeight;
+
+	int						m_nTilesX;
+	int						m_nTilesY;
+	std::vector< std::vector<int> >	m_Bins;			// Command indices per tile, capacity reused
+};
+
+#endif // _CTILECOMPOSITOR_H_
@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// File: CTripleBuffer.h
+//
+// Desc: Lock free single producer / single consumer triple buffer. The
+//	   producer always has a slot to write into and the consumer always
+//	   reads the most recently completed one; neither side ever waits.
+//-----------------------------------------------------------------------------
+
+#ifndef _CTRIPLEBUFFER_H_
+#define _CTRIPLEBUFFER_H_
+
+//-----------------------------------------------------------------------------
+// CTripleBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Main Class Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTripleBuffer (Template Class)
+// Desc : Three slots of T. One is owned by the writer, one by the reader and
+//		the third (the "middle") is handed over through a single atomic that
+//		also carries a flag saying whether it holds unread data.
+//-----------------------------------------------------------------------------
+template <typename T>
+class CTripleBuffer
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	CTripleBuffer() : m_nMiddle( 1 ), m_nWrite( 0 ), m_nRead( 2 ) { }
+
+	//-------------------------------------------------------------------------
+	// Producer side
+	//-------------------------------------------------------------------------
+	T&		GetWriteBuffer( )	{ return m_Slots[m_nWrite]; }
+
+	// Hands the write slot to the reader and takes the middle one back
+	void	Publish( )
+	{
+		m_nWrite = m_nMiddle.exchange( m_nWrite | FLAG_FRESH, std::memory_order_acq_rel ) & INDEX_MASK;
+	}
+
+	//-------------------------------------------------------------------------
+	// Consumer side
+	//-------------------------------------------------------------------------
+	// Swaps in the newest published slot, false if nothing new arrived
+	bool	Acquire( )
+	{
+		if ( !( m_nMiddle.load( std::memory_order_relaxed ) & FLAG_FRESH ) ) return false;
+		m_nRead = m_nMiddle.exchange( m_nRead, std::memory_order_acq_rel ) & INDEX_MASK;
+		return true;
+	}
+
+	const T& GetReadBuffer( ) const	{ return m_Slots[m_nRead]; }
+	T&		 GetSlot( int i )		{ return m_Slots[i]; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Constants for This Class.
+	//-------------------------------------------------------------------------
+	enum { INDEX_MASK = 0x3, FLAG_FRESH = 0x4 };
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	T						m_Slots[3];
+	std::atomic<int>		m_nMiddle;		// Middle slot index | FLAG_FRESH
+	int						m_nWrite;		// Producer owned
+	int						m_nRead;		// Consumer owned
+};
+
+#endif // _CTRIPLEBUFFER_H_
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+// File: EntityTypes.h
+//
+// Desc: Compile time tables describing the planes: what each facing looks
+//	   like and where it aims, what each weapon does, and where each kind
+//	   of plane spawns and with which facing and weapon. CPlayer, CGameApp
+//	   and the AI simulation (CSimState) read their behaviour from here
+//	   instead of switching on flags, so a new weapon or plane kind is a
+//	   new row.
+//-----------------------------------------------------------------------------
+
+#ifndef _ENTITYTYPES_H_
+#define _ENTITYTYPES_H_
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+enum FACING
+{
+	FACING_FORWARD,
+	FACING_BACKWARD,
+	FACING_LEFT,
+	FACING_RIGHT,
+	FACING_COUNT,
+	FACING_ANY		= FACING_COUNT,		// EntityType::eAim, follow the plane
+};
+
+enum WEAPON
+{
+	WEAPON_CANNON,
+	WEAPON_COUNT
+};
+
+enum ENTITY_KIND
+{
+	KIND_PLAYER_1,			// Starts at the bottom, aims where it faces
+	KIND_PLAYER_2,			// Starts at the top, always fires down
+	KIND_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Structures
+//-----------------------------------------------------------------------------
+struct FacingType
+{
+	const char*		szBitmap;			// Sprite fallback, magenta keyed
+	const char*		szRegion;			// Sprite atlas region
+	FACING			eRotateLeft;		// Facing after CPlayer::RotateLeft
+	int				nStepX, nStepY;		// Bullet direction when aiming this way
+};
+
+struct WeaponType
+{
+	int				nFirstShotTicks;	// Cooldown after a respawn
+	int				nReloadTicks;		// Cooldown after a shot
+	int				nReadyBelow;		// Can fire once the cooldown drops under this
+	float			fBulletSpeed;		// Pixels per second along the aim step
+	const char*		szBitmap;			// Bullet sprite fallback
+	const char*		szMask;
+	const char*		szRegion;
+};
+
+struct EntityType
+{
+	FACING			eStartFacing;
+	FACING			eAim;				// Bullets fly this way, FACING_ANY follows the facing
+	int				nShootDir;			// +1 spawns bullets above the plane, -1 below
+	WEAPON			eWeapon;
+	float			fSpawnX, fSpawnY;	// Start and respawn position, CSimState models it too
+};
+
+//-----------------------------------------------------------------------------
+// Tables
+//-----------------------------------------------------------------------------
+// In the order of the plane masks in CGameApp
+constexpr FacingType	FACING_TYPES[FACING_COUNT] =
+{
+	{ "data/planeimgandmask.bmp",		"plane_up",		FACING_LEFT,		 0, -1 },
+	{ "data/planeimgandmaskk.bmp",		"plane_down",	FACING_RIGHT,		 0,  1 },
+	{ "data/planeimgandmaskLeft.bmp",	"plane_left",	FACING_BACKWARD,	-1,  0 },
+	{ "data/planeimgandmaskRight.bmp",	"plane_right",	FACING_FORWARD,		 1,  0 },
+};
+
+// Timing in simulation ticks, one pixel per tick at 60 fps
+constexpr WeaponType	WEAPON_TYPES[WEAPON_COUNT] =
+{
+	{ 30, 100, 25, 60.0f, "data/b.bmp", "data/bm.bmp", "bullet" },
+};
+
+constexpr EntityType	ENTITY_TYPES[KIND_COUNT] =
+{
+	{ FACING_FORWARD,	FACING_ANY,			 1, WEAPON_CANNON, 100.0f, 400.0f },
+	{ FACING_BACKWARD,	FACING_BACKWARD,	-1, WEAPON_CANNON, 600.0f,   0.0f },
+};
+
+//-----------------------------------------------------------------------------
+// Name : RotationIsCycle ()
+// Desc : True when left turns from FACING_FORWARD visit every facing once
+//		before coming back.
+//-----------------------------------------------------------------------------
+constexpr bool RotationIsCycle()
+{
+	int f = FACING_FORWARD;
+	for ( int n = 1; n <= FACING_COUNT; ++n )
+	{
+		f = FACING_TYPES[f].eRotateLeft;
+		if ( ( f == FACING_FORWARD ) != ( n == FACING_COUNT ) ) return false;
+	}
+	return true;
+}
+
+static_assert( RotationIsCycle(), "FACING_TYPES rotation must cycle through all four facings" );
+
+#endif // _ENTITYTYPES_H_
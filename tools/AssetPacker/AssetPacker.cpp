@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// File: AssetPacker.cpp
+//
+// Desc: Offline asset packer. Writes every listed file into one pack with a
+//	   hashed index and aligned entries, optionally LZ4 compressing them.
+//
+//	   Usage : AssetPacker <output.pak> [-z] <file> [<file> ...]
+//	   Files are stored under the path given on the command line, so run it
+//	   from the game directory (e.g. AssetPacker data/assets.pak -z data/*.wav).
+//	   With -z an entry is only kept compressed when that saves at least 1/8.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// AssetPacker Specific Includes
+//-----------------------------------------------------------------------------
+#include "AssetPackFormat.h"
+#include "CLZ4Block.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Name : ReadFile ()
+// Desc : Reads a whole file.
+//-----------------------------------------------------------------------------
+static bool ReadFile( const char* szPath, std::vector<unsigned char>& Out )
+{
+	FILE* pFile = fopen( szPath, "rb" );
+	if ( !pFile ) return false;
+
+	unsigned char Buffer[65536];
+	size_t nRead;
+	Out.clear();
+	while ( ( nRead = fread( Buffer, 1, sizeof(Buffer), pFile ) ) > 0 ) Out.insert( Out.end(), Buffer, Buffer + nRead );
+	fclose( pFile );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : PadTo ()
+// Desc : Writes zero bytes until the file position is a multiple of nAlign.
+//-----------------------------------------------------------------------------
+static void PadTo( FILE* pFile, uint64_t& nPos, uint32_t nAlign )
+{
+	static const unsigned char Zero[PACK_ALIGNMENT] = { 0 };
+	uint64_t nPad = ( nAlign - nPos % nAlign ) % nAlign;
+	fwrite( Zero, 1, (size_t)nPad, pFile );
+	nPos += nPad;
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+// Desc : Entry point.
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	if ( argc < 3 )
+	{
+		fprintf( stderr, "Usage: AssetPacker <output.pak> [-z] <file> [<file> ...]\n" );
+		return 1;
+	}
+
+	bool bCompress = false;
+	std::vector<const char*> Files;
+	for ( int i = 2; i < argc; ++i )
+	{
+		if ( strcmp( argv[i], "-z" ) == 0 ) bCompress = true;
+		else Files.push_back( argv[i] );
+	}
+
+	// Index sized to at most 50% load
+	uint32_t nBuckets = 16;
+	while ( nBuckets < Files.size() * 2 ) nBuckets *= 2;
+	std::vector<PackEntry> Index( nBuckets );
+	memset( &Index[0], 0, nBuckets * sizeof(PackEntry) );
+
+	FILE* pOut = fopen( argv[1], "wb" );
+	if ( !pOut ) { fprintf( stderr, "Cannot write %s\n", argv[1] ); return 1; }
+
+	PackHeader Header;
+	memset( &Header, 0, sizeof(Header) );
+	fwrite( &Header, sizeof(Header), 1, pOut );
+	uint64_t nPos = sizeof(Header);
+
+	uint64_t nRawTotal = 0, nPackedTotal = 0;
+	std::vector<unsigned char> Data, Packed;
+	for ( size_t f = 0; f < Files.size(); ++f )
+	{
+		if ( !ReadFile( Files[f], Data ) ) { fprintf( stderr, "Cannot read %s\n", Files[f] ); fclose( pOut ); return 1; }
+
+		uint64_t nHash = HashAssetPath( Files[f] );
+		uint32_t nBucket = (uint32_t)nHash & ( nBuckets - 1 );
+		while ( Index[nBucket].Hash != 0 )
+		{
+			if ( Index[nBucket].Hash == nHash ) { fprintf( stderr, "Duplicate or colliding path %s\n", Files[f] ); fclose( pOut ); return 1; }
+			nBucket = ( nBucket + 1 ) & ( nBuckets - 1 );
+		}
+
+		PackEntry& e = Index[nBucket];
+		e.Hash	= nHash;
+		e.Size	= (uint32_t)Data.size();
+		e.Flags	= 0;
+
+		const std::vector<unsigned char>* pStore = &Data;
+		if ( bCompress && !Data.empty() )
+		{
+			CLZ4Block::Compress( &Data[0], Data.size(), Packed );
+			if ( Packed.size() < Data.size() - Data.size() / 8 ) { pStore = &Packed; e.Flags |= PACK_FLAG_LZ4; }
+		}
+
+		PadTo( pOut, nPos, PACK_ALIGNMENT );
+		e.Offset		= nPos;
+		e.PackedSize	= (uint32_t)pStore->size();
+		if ( !pStore->empty() ) fwrite( &(*pStore)[0], 1, pStore->size(), pOut );
+		nPos += pStore->size();
+
+		nRawTotal	 += e.Size;
+		nPackedTotal += e.PackedSize;
+		printf( "%-40s %10u -> %10u%s\n", Files[f], e.Size, e.PackedSize, ( e.Flags & PACK_FLAG_LZ4 ) ? " lz4" : "" );
+	}
+
+	PadTo( pOut, nPos, PACK_ALIGNMENT );
+	fwrite( &Index[0], sizeof(PackEntry), nBuckets, pOut );
+
+	memcpy( Header.Magic, PACK_MAGIC, 4 );
+	Header.Version		= PACK_VERSION;
+	Header.nEntries		= (uint32_t)Files.size();
+	Header.nBuckets		= nBuckets;
+	Header.IndexOffset	= nPos;
+	fseek( pOut, 0, SEEK_SET );
+	fwrite( &Header, sizeof(Header), 1, pOut );
+	fclose( pOut );
+
+	printf( "%u files, %llu -> %llu bytes\n", (unsigned int)Files.size(), (unsigned long long)nRawTotal, (unsigned long long)nPackedTotal );
+	return 0;
+}
@@ -0,0 +1,386 @@
+//-----------------------------------------------------------------------------
+// File: AtlasPacker.cpp
+//
+// Desc: Offline sprite atlas packer. Reads the sprite manifest, combines every
+//	   sprite, rotation, animation frame and mask into one image / mask pair
+//	   and writes a text index of the sub rectangles for CSpriteAtlas.
+//
+//	   Usage : AtlasPacker <data dir> <manifest> [max size]
+//	   Output: <data dir>/atlas.bmp, atlasmask.bmp, atlas.idx
+//
+//	   An image named @font5x7 is generated instead of loaded: printable
+//	   ASCII from a built in 5x7 font, one glyph per frame, for the HUD.
+//
+//	   Platform independent on purpose so it can run as part of any build.
+//	   Build it with the game's CBmpDecoder.cpp, which parses the bitmaps.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// AtlasPacker Specific Includes
+//-----------------------------------------------------------------------------
+#include "CBmpDecoder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Local Structures
+//-----------------------------------------------------------------------------
+struct Image
+{
+	int							Width;
+	int							Height;
+	std::vector<unsigned char>	Pixels;		// Top down, 3 bytes per pixel (B, G, R)
+};
+
+struct Entry
+{
+	std::string		Name;
+	Image			Color;		// Transparent pixels forced to black
+	Image			Mask;		// White where transparent, black where opaque
+	int				x, y;		// Placement in the atlas
+};
+
+//-----------------------------------------------------------------------------
+// Local Constants
+//-----------------------------------------------------------------------------
+const int PADDING = 1;
+
+// Printable ASCII (32..126), 5 columns per glyph, bit 0 is the top row.
+// Row 7 is only used by descenders.
+const unsigned char FONT_5X7[95][5] =
+{
+	{ 0x00,0x00,0x00,0x00,0x00 }, { 0x00,0x00,0x5F,0x00,0x00 }, { 0x00,0x07,0x00,0x07,0x00 }, { 0x14,0x7F,0x14,0x7F,0x14 },	//  !"#
+	{ 0x24,0x2A,0x7F,0x2A,0x12 }, { 0x23,0x13,0x08,0x64,0x62 }, { 0x36,0x49,0x56,0x20,0x50 }, { 0x00,0x08,0x07,0x03,0x00 },	// $%&'
+	{ 0x00,0x1C,0x22,0x41,0x00 }, { 0x00,0x41,0x22,0x1C,0x00 }, { 0x2A,0x1C,0x7F,0x1C,0x2A }, { 0x08,0x08,0x3E,0x08,0x08 },	// ()*+
+	{ 0x00,0x80,0x70,0x30,0x00 }, { 0x08,0x08,0x08,0x08,0x08 }, { 0x00,0x00,0x60,0x60,0x00 }, { 0x20,0x10,0x08,0x04,0x02 },	// ,-./
+	{ 0x3E,0x51,0x49,0x45,0x3E }, { 0x00,0x42,0x7F,0x40,0x00 }, { 0x72,0x49,0x49,0x49,0x46 }, { 0x21,0x41,0x49,0x4D,0x33 },	// 0123
+	{ 0x18,0x14,0x12,0x7F,0x10 }, { 0x27,0x45,0x45,0x45,0x39 }, { 0x3C,0x4A,0x49,0x49,0x31 }, { 0x41,0x21,0x11,0x09,0x07 },	// 4567
+	{ 0x36,0x49,0x49,0x49,0x36 }, { 0x46,0x49,0x49,0x29,0x1E }, { 0x00,0x00,0x14,0x00,0x00 }, { 0x00,0x40,0x34,0x00,0x00 },	// 89:;
+	{ 0x00,0x08,0x14,0x22,0x41 }, { 0x14,0x14,0x14,0x14,0x14 }, { 0x00,0x41,0x22,0x14,0x08 }, { 0x02,0x01,0x59,0x09,0x06 },	// <=>?
+	{ 0x3E,0x41,0x5D,0x59,0x4E }, { 0x7C,0x12,0x11,0x12,0x7C }, { 0x7F,0x49,0x49,0x49,0x36 }, { 0x3E,0x41,0x41,0x41,0x22 },	// @ABC
+	{ 0x7F,0x41,0x41,0x41,0x3E }, { 0x7F,0x49,0x49,0x49,0x41 }, { 0x7F,0x09,0x09,0x09,0x01 }, { 0x3E,0x41,0x41,0x51,0x73 },	// DEFG
+	{ 0x7F,0x08,0x08,0x08,0x7F }, { 0x00,0x41,0x7F,0x41,0x00 }, { 0x20,0x40,0x41,0x3F,0x01 }, { 0x7F,0x08,0x14,0x22,0x41 },	// HIJK
+	{ 0x7F,0x40,0x40,0x40,0x40 }, { 0x7F,0x02,0x1C,0x02,0x7F }, { 0x7F,0x04,0x08,0x10,0x7F }, { 0x3E,0x41,0x41,0x41,0x3E },	// LMNO
+	{ 0x7F,0x09,0x09,0x09,0x06 }, { 0x3E,0x41,0x51,0x21,0x5E }, { 0x7F,0x09,0x19,0x29,0x46 }, { 0x26,0x49,0x49,0x49,0x32 },	// PQRS
+	{ 0x03,0x01,0x7F,0x01,0x03 }, { 0x3F,0x40,0x40,0x40,0x3F }, { 0x1F,0x20,0x40,0x20,0x1F }, { 0x3F,0x40,0x38,0x40,0x3F },	// TUVW
+	{ 0x63,0x14,0x08,0x14,0x63 }, { 0x03,0x04,0x78,0x04,0x03 }, { 0x61,0x59,0x49,0x4D,0x43 }, { 0x00,0x7F,0x41,0x41,0x41 },	// XYZ[
+	{ 0x02,0x04,0x08,0x10,0x20 }, { 0x00,0x41,0x41,0x41,0x7F }, { 0x04,0x02,0x01,0x02,0x04 }, { 0x40,0x40,0x40,0x40,0x40 },	// \]^_
+	{ 0x00,0x03,0x07,0x08,0x00 }, { 0x20,0x54,0x54,0x78,0x40 }, { 0x7F,0x28,0x44,0x44,0x38 }, { 0x38,0x44,0x44,0x44,0x28 },	// `abc
+	{ 0x38,0x44,0x44,0x28,0x7F }, { 0x38,0x54,0x54,0x54,0x18 }, { 0x00,0x08,0x7E,0x09,0x02 }, { 0x18,0xA4,0xA4,0x9C,0x78 },	// defg
+	{ 0x7F,0x08,0x04,0x04,0x78 }, { 0x00,0x44,0x7D,0x40,0x00 }, { 0x20,0x40,0x40,0x3D,0x00 }, { 0x7F,0x10,0x28,0x44,0x00 },	// hijk
+	{ 0x00,0x41,0x7F,0x40,0x00 }, { 0x7C,0x04,0x78,0x04,0x78 }, { 0x7C,0x08,0x04,0x04,0x78 }, { 0x38,0x44,0x44,0x44,0x38 },	// lmno
+	{ 0xFC,0x18,0x24,0x24,0x18 }, { 0x18,0x24,0x24,0x18,0xFC }, { 0x7C,0x08,0x04,0x04,0x08 }, { 0x48,0x54,0x54,0x54,0x24 },	// pqrs
+	{ 0x04,0x04,0x3F,0x44,0x24 }, { 0x3C,0x40,0x40,0x20,0x7C }, { 0x1C,0x20,0x40,0x20,0x1C }, { 0x3C,0x40,0x30,0x40,0x3C },	// tuvw
+	{ 0x44,0x28,0x10,0x28,0x44 }, { 0x4C,0x90,0x90,0x90,0x7C }, { 0x44,0x64,0x54,0x4C,0x44 }, { 0x00,0x08,0x36,0x41,0x00 },	// xyz{
+	{ 0x00,0x00,0x77,0x00,0x00 }, { 0x00,0x41,0x36,0x08,0x00 }, { 0x02,0x01,0x02,0x04,0x02 },									// |}~
+};
+
+//-----------------------------------------------------------------------------
+// Name : WriteU16 / WriteU32 ()
+// Desc : Little endian helpers, BMP headers are little endian.
+//-----------------------------------------------------------------------------
+static void WriteU16( unsigned char* p, unsigned int v ) { p[0] = (unsigned char)v; p[1] = (unsigned char)( v >> 8 ); }
+static void WriteU32( unsigned char* p, unsigned int v ) { WriteU16( p, v & 0xFFFF ); WriteU16( p + 2, v >> 16 ); }
+
+//-----------------------------------------------------------------------------
+// Name : LoadBMP ()
+// Desc : Loads an uncompressed 24 or 32 bit BMP as top down BGR, parsed by
+//		the game's CBmpDecoder.
+//-----------------------------------------------------------------------------
+static bool LoadBMP( const std::string& Path, Image& Out )
+{
+	FILE* pFile = fopen( Path.c_str(), "rb" );
+	if ( !pFile ) { fprintf( stderr, "Cannot open %s\n", Path.c_str() ); return false; }
+
+	std::vector<unsigned char> Data;
+	unsigned char Buffer[4096];
+	size_t nRead;
+	while ( ( nRead = fread( Buffer, 1, sizeof(Buffer), pFile ) ) > 0 ) Data.insert( Data.end(), Buffer, Buffer + nRead );
+	fclose( pFile );
+
+	// Same parser, and the same header checks, as the game's loader
+	CBmpDecoder::Image Decoded;
+	if ( Data.empty() || !CBmpDecoder::Decode( &Data[0], Data.size(), Decoded ) )
+	{
+		fprintf( stderr, "%s: not an uncompressed 24/32 bit BMP, or damaged\n", Path.c_str() );
+		return false;
+	}
+
+	Out.Width	= Decoded.nWidth;
+	Out.Height	= Decoded.nHeight;
+	Out.Pixels.resize( Decoded.Pixels.size() * 3 );
+
+	unsigned char* pDst = Out.Pixels.empty() ? NULL : &Out.Pixels[0];
+	for ( uint32_t Pixel : Decoded.Pixels )
+	{
+		*pDst++ = (unsigned char)( Pixel );
+		*pDst++ = (unsigned char)( Pixel >> 8 );
+		*pDst++ = (unsigned char)( Pixel >> 16 );
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SaveBMP ()
+// Desc : Writes a bottom up 24 bit BMP.
+//-----------------------------------------------------------------------------
+static bool SaveBMP( const std::string& Path, const Image& In )
+{
+	size_t nStride	= ( In.Width * 3 + 3 ) & ~3u;
+	size_t nSize	= 54 + nStride * In.Height;
+
+	std::vector<unsigned char> Data( nSize, 0 );
+	Data[0] = 'B'; Data[1] = 'M';
+	WriteU32( &Data[2], (unsigned int)nSize );
+	WriteU32( &Data[10], 54 );
+	WriteU32( &Data[14], 40 );
+	WriteU32( &Data[18], In.Width );
+	WriteU32( &Data[22], In.Height );
+	WriteU16( &Data[26], 1 );
+	WriteU16( &Data[28], 24 );
+	WriteU32( &Data[34], (unsigned int)( nStride * In.Height ) );
+
+	for ( int y = 0; y < In.Height; ++y )
+		memcpy( &Data[ 54 + nStride * ( In.Height - 1 - y ) ], &In.Pixels[ (size_t)y * In.Width * 3 ], In.Width * 3 );
+
+	FILE* pFile = fopen( Path.c_str(), "wb" );
+	if ( !pFile ) { fprintf( stderr, "Cannot write %s\n", Path.c_str() ); return false; }
+	bool bOk = fwrite( &Data[0], 1, nSize, pFile ) == nSize;
+	fclose( pFile );
+	return bOk;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Crop ()
+// Desc : Copies a sub rectangle out of an image.
+//-----------------------------------------------------------------------------
+static Image Crop( const Image& In, int x0, int y0, int nWidth, int nHeight )
+{
+	Image Out;
+	Out.Width	= nWidth;
+	Out.Height	= nHeight;
+	Out.Pixels.resize( (size_t)nWidth * nHeight * 3 );
+	for ( int y = 0; y < nHeight; ++y )
+		memcpy( &Out.Pixels[ (size_t)y * nWidth * 3 ], &In.Pixels[ ( (size_t)( y0 + y ) * In.Width + x0 ) * 3 ], nWidth * 3 );
+	return Out;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFont ()
+// Desc : Renders FONT_5X7 as a one row sheet of nFrames cells, each 6 x 8
+//		font pixels scaled to nCellW x nCellH. Glyphs are white with a one
+//		pixel black drop shadow on a magenta (#ff00ff) key.
+//-----------------------------------------------------------------------------
+static bool BuildFont( int nCellW, int nCellH, int nFrames, Image& Out )
+{
+	int nScale = nCellW / 6;
+	if ( nScale < 1 || nCellW != nScale * 6 || nCellH != nScale * 8 || nFrames < 1 || nFrames > 95 )
+	{
+		fprintf( stderr, "@font5x7: frames must be 6n x 8n and at most 95 of them\n" );
+		return false;
+	}
+
+	Out.Width	= nCellW * nFrames;
+	Out.Height	= nCellH;
+	Out.Pixels.resize( (size_t)Out.Width * Out.Height * 3 );
+	for ( size_t i = 0; i < Out.Pixels.size(); i += 3 )
+	{
+		Out.Pixels[i] = 0xFF; Out.Pixels[i + 1] = 0x00; Out.Pixels[i + 2] = 0xFF;
+	}
+
+	// Shadow pass first, then the glyph over it
+	for ( int nPass = 0; nPass < 2; ++nPass )
+	{
+		int			  nOffset = ( nPass == 0 ) ? 1 : 0;
+		unsigned char c		  = ( nPass == 0 ) ? 0x00 : 0xFF;
+
+		for ( int f = 0; f < nFrames; ++f )
+			for ( int gx = 0; gx < 5; ++gx )
+				for ( int gy = 0; gy < 8; ++gy )
+				{
+					if ( !( FONT_5X7[f][gx] & ( 1 << gy ) ) ) continue;
+
+					for ( int sy = 0; sy < nScale; ++sy )
+						for ( int sx = 0; sx < nScale; ++sx )
+						{
+							int x = gx * nScale + sx + nOffset, y = gy * nScale + sy + nOffset;
+							if ( x >= nCellW || y >= nCellH ) continue;
+
+							unsigned char* p = &Out.Pixels[ ( (size_t)y * Out.Width + f * nCellW + x ) * 3 ];
+							p[0] = p[1] = p[2] = c;
+						}
+				}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MakeEntry ()
+// Desc : Builds the colour / mask pair for a sprite from either a mask image
+//		or a colour key, normalising both to the SRCAND / SRCPAINT layout.
+//-----------------------------------------------------------------------------
+static bool MakeEntry( const std::string& Name, const Image& Color, const Image* pMask, unsigned int nKey, Entry& Out )
+{
+	if ( pMask && ( pMask->Width != Color.Width || pMask->Height != Color.Height ) )
+	{
+		fprintf( stderr, "%s: mask size does not match image\n", Name.c_str() );
+		return false;
+	}
+
+	Out.Name	= Name;
+	Out.Color	= Color;
+	Out.Mask	= Color;
+
+	unsigned char kb = nKey & 0xFF, kg = ( nKey >> 8 ) & 0xFF, kr = ( nKey >> 16 ) & 0xFF;
+	for ( size_t i = 0; i < Color.Pixels.size(); i += 3 )
+	{
+		bool bTransparent = pMask ? ( pMask->Pixels[i] > 127 ) :
+			( Color.Pixels[i] == kb && Color.Pixels[i + 1] == kg && Color.Pixels[i + 2] == kr );
+
+		unsigned char m = bTransparent ? 0xFF : 0x00;
+		Out.Mask.Pixels[i] = Out.Mask.Pixels[i + 1] = Out.Mask.Pixels[i + 2] = m;
+		if ( bTransparent ) Out.Color.Pixels[i] = Out.Color.Pixels[i + 1] = Out.Color.Pixels[i + 2] = 0;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Pack ()
+// Desc : Shelf packs the entries (tallest first) into nSize x nSize.
+//		Returns the used height, or -1 if they do not fit.
+//-----------------------------------------------------------------------------
+static int Pack( std::vector<Entry*>& Sorted, int nSize )
+{
+	int x = 0, y = 0, nShelf = 0;
+	for ( size_t i = 0; i < Sorted.size(); ++i )
+	{
+		Entry& e = *Sorted[i];
+		if ( e.Color.Width + PADDING > nSize ) return -1;
+
+		if ( x + e.Color.Width + PADDING > nSize ) { x = 0; y += nShelf; nShelf = 0; }
+		if ( y + e.Color.Height + PADDING > nSize ) return -1;
+
+		e.x = x;
+		e.y = y;
+		x += e.Color.Width + PADDING;
+		nShelf = std::max( nShelf, e.Color.Height + PADDING );
+	}
+	return y + nShelf;
+}
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+// Desc : Entry point.
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	if ( argc < 3 )
+	{
+		fprintf( stderr, "Usage: AtlasPacker <data dir> <manifest> [max size]\n" );
+		return 1;
+	}
+
+	std::string DataDir = argv[1];
+	if ( !DataDir.empty() && DataDir[ DataDir.size() - 1 ] != '/' && DataDir[ DataDir.size() - 1 ] != '\\' ) DataDir += '/';
+	int nMaxSize = ( argc > 3 ) ? atoi( argv[3] ) : 4096;
+
+	FILE* pManifest = fopen( argv[2], "r" );
+	if ( !pManifest ) { fprintf( stderr, "Cannot open manifest %s\n", argv[2] ); return 1; }
+
+	// Read every manifest line into one or more atlas entries
+	std::vector<Entry> Entries;
+	char Line[512];
+	while ( fgets( Line, sizeof(Line), pManifest ) )
+	{
+		char Name[128], ImageFile[256], MaskSpec[256];
+		int  nFrameW = 0, nFrameH = 0, nFrames = 0;
+
+		if ( Line[0] == '#' ) continue;
+		int nFields = sscanf( Line, "%127s %255s %255s %d %d %d", Name, ImageFile, MaskSpec, &nFrameW, &nFrameH, &nFrames );
+		if ( nFields < 3 ) continue;
+
+		Image Color, Mask;
+		unsigned int nKey = 0;
+		if ( strcmp( ImageFile, "@font5x7" ) == 0 )
+		{
+			if ( nFields < 6 || !BuildFont( nFrameW, nFrameH, nFrames, Color ) ) { fclose( pManifest ); return 1; }
+		}
+		else if ( !LoadBMP( DataDir + ImageFile, Color ) ) { fclose( pManifest ); return 1; }
+		if ( MaskSpec[0] == '#' ) nKey = (unsigned int)strtoul( MaskSpec + 1, NULL, 16 );
+		else if ( !LoadBMP( DataDir + MaskSpec, Mask ) ) { fclose( pManifest ); return 1; }
+		const Image* pMask = ( MaskSpec[0] == '#' ) ? NULL : &Mask;
+
+		if ( nFields < 6 )
+		{
+			Entries.push_back( Entry() );
+			if ( !MakeEntry( Name, Color, pMask, nKey, Entries.back() ) ) { fclose( pManifest ); return 1; }
+			continue;
+		}
+
+		// Animation sheet, frames are laid out row major
+		int nCols = Color.Width / nFrameW;
+		for ( int f = 0; f < nFrames; ++f )
+		{
+			int fx = ( f % nCols ) * nFrameW, fy = ( f / nCols ) * nFrameH;
+			if ( fy + nFrameH > Color.Height ) { fprintf( stderr, "%s: sheet has fewer than %d frames\n", Name, nFrames ); fclose( pManifest ); return 1; }
+
+			Image FrameMask, FrameColor = Crop( Color, fx, fy, nFrameW, nFrameH );
+			if ( pMask ) FrameMask = Crop( Mask, fx, fy, nFrameW, nFrameH );
+
+			char FrameName[160];
+			snprintf( FrameName, sizeof(FrameName), "%s#%d", Name, f );
+			Entries.push_back( Entry() );
+			if ( !MakeEntry( FrameName, FrameColor, pMask ? &FrameMask : NULL, nKey, Entries.back() ) ) { fclose( pManifest ); return 1; }
+		}
+	}
+	fclose( pManifest );
+
+	if ( Entries.empty() ) { fprintf( stderr, "Manifest lists no sprites\n" ); return 1; }
+
+	// Smallest power of two square that fits everything
+	std::vector<Entry*> Sorted;
+	for ( size_t i = 0; i < Entries.size(); ++i ) Sorted.push_back( &Entries[i] );
+	std::stable_sort( Sorted.begin(), Sorted.end(), []( const Entry* a, const Entry* b ) { return a->Color.Height > b->Color.Height; } );
+
+	int nSize = 64, nUsedHeight = -1;
+	for ( ; nSize <= nMaxSize; nSize *= 2 )
+		if ( ( nUsedHeight = Pack( Sorted, nSize ) ) >= 0 ) break;
+	if ( nUsedHeight < 0 ) { fprintf( stderr, "Sprites do not fit in %dx%d\n", nMaxSize, nMaxSize ); return 1; }
+
+	// Blit everything into the atlas pair. Unused mask area stays white.
+	Image Atlas, AtlasMask;
+	Atlas.Width  = AtlasMask.Width  = nSize;
+	Atlas.Height = AtlasMask.Height = nUsedHeight;
+	Atlas.Pixels.assign( (size_t)nSize * nUsedHeight * 3, 0x00 );
+	AtlasMask.Pixels.assign( (size_t)nSize * nUsedHeight * 3, 0xFF );
+
+	FILE* pIndex = fopen( ( DataDir + "atlas.idx" ).c_str(), "w" );
+	if ( !pIndex ) { fprintf( stderr, "Cannot write atlas.idx\n" ); return 1; }
+	fprintf( pIndex, "# name x y width height\n" );
+
+	for ( size_t i = 0; i < Entries.size(); ++i )
+	{
+		const Entry& e = Entries[i];
+		for ( int y = 0; y < e.Color.Height; ++y )
+		{
+			size_t nDst = ( (size_t)( e.y + y ) * nSize + e.x ) * 3;
+			size_t nSrc = (size_t)y * e.Color.Width * 3;
+			memcpy( &Atlas.Pixels[nDst], &e.Color.Pixels[nSrc], e.Color.Width * 3 );
+			memcpy( &AtlasMask.Pixels[nDst], &e.Mask.Pixels[nSrc], e.Color.Width * 3 );
+		}
+		fprintf( pIndex, "%s %d %d %d %d\n", e.Name.c_str(), e.x, e.y, e.Color.Width, e.Color.Height );
+	}
+	fclose( pIndex );
+
+	if ( !SaveBMP( DataDir + "atlas.bmp", Atlas ) || !SaveBMP( DataDir + "atlasmask.bmp", AtlasMask ) ) return 1;
+
+	printf( "Packed %u sprites into %dx%d\n", (unsigned int)Entries.size(), nSize, nUsedHeight );
+	return 0;
+}
@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------------
+// File: BmpBench.cpp
+//
+// Desc: Throughput benchmark for CBmpDecoder. Decodes each bitmap from
+//	   memory with the scalar and SIMD row converters, checks they agree,
+//	   and on Windows times the loader the game used before
+//	   (LoadImage(LR_LOADFROMFILE) + GetDIBits, as CImageFile and Sprite do).
+//
+//	   Usage : BmpBench [-n iterations] [-k RRGGBB] <file.bmp> [<file.bmp> ...]
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BmpBench Specific Includes
+//-----------------------------------------------------------------------------
+#include "CBmpDecoder.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : ReadFile ()
+// Desc : Reads a whole file.
+//-----------------------------------------------------------------------------
+static bool ReadFile( const char* szPath, std::vector<unsigned char>& Out )
+{
+	FILE* pFile = fopen( szPath, "rb" );
+	if ( !pFile ) return false;
+
+	unsigned char Buffer[65536];
+	size_t nRead;
+	Out.clear();
+	while ( ( nRead = fread( Buffer, 1, sizeof(Buffer), pFile ) ) > 0 ) Out.insert( Out.end(), Buffer, Buffer + nRead );
+	fclose( pFile );
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : NowMs ()
+// Desc : Monotonic time in milliseconds.
+//-----------------------------------------------------------------------------
+static double NowMs( )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Report ()
+// Desc : Prints one timing line.
+//-----------------------------------------------------------------------------
+static void Report( const char* szLabel, double fMs, int nIterations, double fPixels )
+{
+	double fPer = fMs / nIterations;
+	printf( "  %-28s %9.3f ms  %8.1f Mpix/s\n", szLabel, fPer, fPixels / ( fPer * 1000.0 ) );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchDecoder ()
+// Desc : Times CBmpDecoder with SIMD on or off, returns ms for all iterations.
+//-----------------------------------------------------------------------------
+static double BenchDecoder( const std::vector<unsigned char>& File, int nIterations, uint32_t nKey, bool bSIMD, CBmpDecoder::Image& Out )
+{
+	CBmpDecoder::EnableSIMD( bSIMD );
+
+	double fStart = NowMs();
+	for ( int i = 0; i < nIterations; ++i )
+		CBmpDecoder::Decode( &File[0], File.size(), Out, nKey );
+	return NowMs() - fStart;
+}
+
+#ifdef _WIN32
+//-----------------------------------------------------------------------------
+// Name : BenchGdi ()
+// Desc : The previous path: load through GDI, then read the bits back.
+//-----------------------------------------------------------------------------
+static double BenchGdi( const char* szPath, int nWidth, int nHeight, int nIterations )
+{
+	HDC hDC = GetDC( NULL );
+
+	BITMAPINFO bmi;
+	memset( &bmi, 0, sizeof(bmi) );
+	bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		= nWidth;
+	bmi.bmiHeader.biHeight		= -nHeight;
+	bmi.bmiHeader.biPlanes		= 1;
+	bmi.bmiHeader.biBitCount	= 32;
+	bmi.bmiHeader.biCompression	= BI_RGB;
+	std::vector<DWORD> Pixels( (size_t)nWidth * nHeight );
+
+	double fStart = NowMs();
+	for ( int i = 0; i < nIterations; ++i )
+	{
+		HBITMAP hBitmap = (HBITMAP)LoadImage( NULL, szPath, IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE );
+		GetDIBits( hDC, hBitmap, 0, nHeight, &Pixels[0], &bmi, DIB_RGB_COLORS );
+		DeleteObject( hBitmap );
+	}
+	double fMs = NowMs() - fStart;
+
+	ReleaseDC( NULL, hDC );
+	return fMs;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : main ()
+// Desc : Entry point.
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	int			nIterations	= 100;
+	uint32_t	nKey		= CBmpDecoder::NO_COLOR_KEY;
+	int			nFailed		= 0;
+
+	int i = 1;
+	for ( ; i < argc && argv[i][0] == '-'; i += 2 )
+	{
+		if ( i + 1 >= argc ) break;
+		if ( strcmp( argv[i], "-n" ) == 0 ) nIterations = atoi( argv[i + 1] );
+		else if ( strcmp( argv[i], "-k" ) == 0 ) nKey = (uint32_t)strtoul( argv[i + 1], NULL, 16 );
+	}
+
+	if ( i >= argc || nIterations <= 0 )
+	{
+		fprintf( stderr, "Usage: BmpBench [-n iterations] [-k RRGGBB] <file.bmp> [<file.bmp> ...]\n" );
+		return 1;
+	}
+
+	printf( "SIMD available: %s\n", CBmpDecoder::HasSIMD() ? "yes" : "no" );
+
+	for ( ; i < argc; ++i )
+	{
+		std::vector<unsigned char> File;
+		CBmpDecoder::Info Info;
+		if ( !ReadFile( argv[i], File ) || !CBmpDecoder::ReadInfo( File.empty() ? NULL : &File[0], File.size(), Info ) )
+		{
+			printf( "%s: not a supported bitmap\n", argv[i] );
+			++nFailed;
+			continue;
+		}
+
+		double fPixels = (double)Info.nWidth * Info.nHeight;
+		printf( "%s: %dx%d %d bpp, %d iterations\n", argv[i], Info.nWidth, Info.nHeight, Info.nBitCount, nIterations );
+
+		CBmpDecoder::Image Scalar, Simd;
+		Report( "CBmpDecoder scalar", BenchDecoder( File, nIterations, nKey, false, Scalar ), nIterations, fPixels );
+		Report( "CBmpDecoder SIMD", BenchDecoder( File, nIterations, nKey, true, Simd ), nIterations, fPixels );
+
+		if ( Scalar.Pixels != Simd.Pixels )
+		{
+			printf( "  MISMATCH between scalar and SIMD output\n" );
+			++nFailed;
+		}
+
+#ifdef _WIN32
+		Report( "LoadImage + GetDIBits (file)", BenchGdi( argv[i], Info.nWidth, Info.nHeight, nIterations ), nIterations, fPixels );
+#endif
+	}
+
+	return nFailed ? 1 : 0;
+}